@@ -0,0 +1,120 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "batch.hpp"
+#include "db.hpp"
+#include "metrics.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr int block_size = 1024;
+
+int
+find(const database& db, const std::string& name) {
+  IMDB_TIME(lookup);
+  return db.actor_lookup.find(name);
+}
+
+// Formats the answer for one name onto the end of s.
+void
+answer(const database& db, const bfs_result& r, const std::string& name,
+       std::string& s, batch_stats& stats) {
+  IMDB_TIME(request);
+  s += name;
+  s += '\t';
+  int a = find(db, name);
+  if (a == -1 || r.distance[a] == unreachable) {
+    s += "-1\t\n";
+    stats.found += a != -1;
+    return;
+  }
+  ++stats.found;
+  ++stats.connected;
+  s += std::to_string(r.distance[a]);
+  s += '\t';
+  IMDB_TIME(path);
+  while (a != r.center) {
+    const role& link = db.roles[r.parent[a]];
+    s += db.movies[link.movie].name;
+    s += " / ";
+    s += db.actors[link.actor].name;
+    if (link.actor != r.center)
+      s += " / ";
+    a = link.actor;
+  }
+  s += '\n';
+}
+
+} // namespace
+
+batch_stats
+run_batch(database& db, int center, const std::vector<std::string>& names,
+          std::FILE* out, int threads) {
+  auto start = std::chrono::steady_clock::now();
+  bfs_ptr r = db.search(center);
+  const database& cdb = db;
+
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  int blocks = (names.size() + block_size - 1) / block_size;
+  std::vector<std::string> text(blocks);
+  std::vector<char> ready(blocks, 0);
+  std::vector<batch_stats> partial(threads);
+  std::atomic<int> next(0);
+  std::mutex m;
+  std::condition_variable cv;
+
+  auto work = [&](int t) {
+    int b;
+    while ((b = next++) < blocks) {
+      std::string s;
+      int lo = b * block_size;
+      int hi = std::min<int>(names.size(), lo + block_size);
+      for (int i = lo; i < hi; ++i)
+        answer(cdb, *r, names[i], s, partial[t]);
+      std::lock_guard<std::mutex> lock(m);
+      text[b].swap(s);
+      ready[b] = 1;
+      cv.notify_one();
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t)
+    pool.emplace_back(work, t);
+
+  // Write blocks as they complete, in order.
+  buffered_writer w(out);
+  for (int b = 0; b < blocks; ++b) {
+    std::string s;
+    {
+      std::unique_lock<std::mutex> lock(m);
+      cv.wait(lock, [&] { return ready[b] != 0; });
+      s.swap(text[b]);
+    }
+    IMDB_TIME(output);
+    IMDB_COUNT(bytes_written, s.size());
+    w.write(s);
+  }
+  w.flush();
+  for (std::thread& t : pool)
+    t.join();
+
+  batch_stats stats;
+  stats.queries = names.size();
+  for (const batch_stats& p : partial) {
+    stats.found += p.found;
+    stats.connected += p.connected;
+  }
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  stats.seconds = dt.count();
+  return stats;
+}
@@ -0,0 +1,39 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_BATCH_HPP
+#define IMDB_BATCH_HPP
+
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct database;
+
+
+// Summary of a batch run.
+struct batch_stats
+{
+  long queries = 0;
+  long found = 0;     // Names that matched an actor
+  long connected = 0; // Matched actors with a path to the center
+  double seconds = 0;
+};
+
+// Answers one query per name, writing a tab-separated line for each in
+// input order:
+//
+//    name <tab> distance <tab> movie / actor / movie / ... / center
+//
+// The distance is -1 for unknown or unreachable actors, and the path is
+// empty. The search from the center runs once up front; the names are
+// then split into blocks that a pool of threads resolves and formats
+// against the read-only database, while the calling thread writes the
+// finished blocks in order through a large buffer.
+batch_stats run_batch(database& db, int center,
+                      const std::vector<std::string>& names,
+                      std::FILE* out, int threads = 0);
+
+
+#endif
@@ -0,0 +1,106 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+// A load generator for the db query daemon. Each connection runs in its
+// own thread and sends requests for random names from the given file one
+// after another, timing each round trip.
+//
+// Usage: db_bench <socket> <names> [connections] [requests] [op]
+//
+// The op is one of lookup, bacon, path, or between (default bacon).
+
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "usage: db_bench <socket> <names> [connections] "
+              << "[requests] [op]\n";
+    return 1;
+  }
+  const char* path = argv[1];
+  int conns = argc > 3 ? std::atoi(argv[3]) : 4;
+  int requests = argc > 4 ? std::atoi(argv[4]) : 10000;
+  std::string opname = argc > 5 ? argv[5] : "bacon";
+  protocol::opcode op = protocol::bacon;
+  if (opname == "lookup")
+    op = protocol::lookup;
+  else if (opname == "path")
+    op = protocol::path;
+  else if (opname == "between")
+    op = protocol::between;
+
+  std::vector<std::string> names;
+  std::ifstream in(argv[2]);
+  std::string line;
+  while (std::getline(in, line))
+    names.push_back(line);
+  if (names.empty() || conns < 1) {
+    std::cerr << "error: no names to query\n";
+    return 1;
+  }
+
+  // Latencies in microseconds, per connection.
+  std::vector<std::vector<double>> latency(conns);
+  std::vector<int> failures(conns, 0);
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  for (int c = 0; c < conns; ++c) {
+    pool.emplace_back([&, c]() {
+      int fd = protocol::connect_unix(path);
+      if (fd < 0) {
+        failures[c] = requests;
+        return;
+      }
+      std::mt19937 gen(c);
+      std::uniform_int_distribution<int> pick(0, names.size() - 1);
+      std::string reply;
+      for (int i = c; i < requests; i += conns) {
+        std::string req = protocol::request(op, names[pick(gen)],
+                                            names[pick(gen)]);
+        auto t0 = std::chrono::steady_clock::now();
+        if (!protocol::send(fd, req) || !protocol::receive(fd, reply)) {
+          ++failures[c];
+          break;
+        }
+        std::chrono::duration<double, std::micro> dt =
+          std::chrono::steady_clock::now() - t0;
+        latency[c].push_back(dt.count());
+        if (reply.empty() || reply[0] != '+')
+          ++failures[c];
+      }
+      ::close(fd);
+    });
+  }
+  for (std::thread& t : pool)
+    t.join();
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+
+  std::vector<double> all;
+  int failed = 0;
+  for (int c = 0; c < conns; ++c) {
+    all.insert(all.end(), latency[c].begin(), latency[c].end());
+    failed += failures[c];
+  }
+  std::sort(all.begin(), all.end());
+  auto pct = [&](double p) {
+    return all.empty() ? 0 : all[std::min<std::size_t>(all.size() - 1,
+                                                       p * all.size())];
+  };
+  std::cout << "* " << all.size() << " requests over " << conns
+            << " connections in " << dt.count() << " s, "
+            << all.size() / dt.count() << " requests/s, " << failed
+            << " failed\n"
+            << "* latency us: p50 " << pct(0.5) << ", p90 " << pct(0.9)
+            << ", p99 " << pct(0.99) << ", max "
+            << (all.empty() ? 0 : all.back()) << '\n';
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "cache.hpp"
+
+// Returns the cached result for the given center, or null if there is
+// none. A hit moves the entry to the front of the list.
+bfs_ptr
+bfs_cache::find(int center) {
+  auto iter = index.find(center);
+  if (iter == index.end()) {
+    ++misses;
+    return nullptr;
+  }
+  ++hits;
+  entries.splice(entries.begin(), entries, iter->second);
+  return *iter->second;
+}
+
+// Adds a result to the cache, evicting old entries to make room. Results
+// larger than the capacity are not cached at all.
+void
+bfs_cache::insert(bfs_ptr r) {
+  std::size_t n = r->bytes();
+  if (n > capacity)
+    return;
+
+  auto iter = index.find(r->center);
+  if (iter != index.end()) {
+    used -= (*iter->second)->bytes();
+    entries.erase(iter->second);
+    index.erase(iter);
+  }
+
+  while (used + n > capacity) {
+    bfs_ptr& last = entries.back();
+    used -= last->bytes();
+    index.erase(last->center);
+    entries.pop_back();
+    ++evictions;
+  }
+
+  entries.push_front(r);
+  index.emplace(r->center, entries.begin());
+  used += n;
+}
+
+// Discards all cached results. This must be done whenever the graph
+// changes.
+void
+bfs_cache::clear() {
+  entries.clear();
+  index.clear();
+  used = 0;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_CACHE_HPP
+#define IMDB_CACHE_HPP
+
+#include "distance.hpp"
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+// The result of a breadth-first search from a single center actor.
+//
+// This is stored compactly: one byte of distance and one role id per
+// actor. The role that links an actor to the search tree names both the
+// previous actor on the path and the movie they share, so a path back to
+// the center can be recovered in time proportional to its length.
+struct bfs_result
+{
+  bfs_result(int c, int n)
+    : center(c), distance(n, unreachable), parent(n, -1)
+  { }
+
+  // Returns the number of bytes needed to store the result.
+  std::size_t bytes() const {
+    return distance.size() * (sizeof(unsigned char) + sizeof(int));
+  }
+
+  int center;
+  std::vector<unsigned char> distance;
+  std::vector<int> parent; // Role of the previous actor on the path
+};
+
+using bfs_ptr = std::shared_ptr<const bfs_result>;
+
+
+// A least-recently-used cache of search results, keyed by center.
+//
+// The capacity is given in bytes. Inserting a result evicts the least
+// recently used entries until the new one fits. Results are shared, so
+// an evicted result stays valid for anyone still holding it.
+struct bfs_cache
+{
+  explicit bfs_cache(std::size_t cap = std::size_t(256) << 20)
+    : capacity(cap)
+  { }
+
+  // Returns the number of cached results.
+  int size() const { return index.size(); }
+
+  bfs_ptr find(int center);
+  void insert(bfs_ptr r);
+  void clear();
+
+  std::size_t capacity; // Maximum number of bytes
+  std::size_t used = 0; // Bytes held by cached results
+
+  long hits = 0;
+  long misses = 0;
+  long evictions = 0;
+
+  // Entries, ordered from most to least recently used.
+  std::list<bfs_ptr> entries;
+  std::unordered_map<int, std::list<bfs_ptr>::iterator> index;
+};
+
+
+#endif
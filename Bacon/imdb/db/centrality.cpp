@@ -0,0 +1,218 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "centrality.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <random>
+#include <thread>
+
+namespace {
+
+// The actor-movie graph without parallel edges: each actor lists each of
+// its movies once and each movie each cast member once, so repeated roles
+// do not add shortest paths. Vertices are numbered with actors first and
+// movies after them. Shared read-only by the workers.
+struct simple_graph
+{
+  simple_graph(const database& db)
+    : actors(db.actors.size()), first(1, 0)
+  {
+    int m = db.movies.size();
+    std::vector<int> seen(actors + m, -1);
+    first.reserve(actors + m + 1);
+    adj.reserve(2 * db.roles.size());
+    for (int a = 0; a < actors; ++a) {
+      for (int x : db.actors[a].roles) {
+        int f = actors + db.roles[x].movie;
+        if (seen[f] != a) {
+          seen[f] = a;
+          adj.push_back(f);
+        }
+      }
+      first.push_back(adj.size());
+    }
+    for (int f = 0; f < m; ++f) {
+      for (int x : db.movies[f].roles) {
+        int a = db.roles[x].actor;
+        if (seen[a] != actors + f) {
+          seen[a] = actors + f;
+          adj.push_back(a);
+        }
+      }
+      first.push_back(adj.size());
+    }
+  }
+
+  int actors;
+  std::vector<int> first; // Offsets into adj, per vertex + 1
+  std::vector<int> adj;
+};
+
+// Scratch space and partial sums for one thread. Vertices are numbered
+// with actors first and movies after them. Only the vertices touched by
+// a search are reset afterwards.
+struct brandes_worker
+{
+  brandes_worker(const simple_graph& g)
+    : g(g), actors(g.actors),
+      dist(g.first.size() - 1, -1),
+      sigma(dist.size(), 0), delta(dist.size(), 0),
+      betweenness(actors, 0), farness(actors, 0), reach(actors, 0)
+  {
+    order.reserve(dist.size());
+  }
+
+  // Calls f(w) for each neighbor of v.
+  template<typename F>
+  void neighbors(int v, F f) {
+    for (int i = g.first[v]; i < g.first[v + 1]; ++i)
+      f(g.adj[i]);
+  }
+
+  void search(int s);
+
+  const simple_graph& g;
+  int actors;
+
+  std::vector<int> dist;
+  std::vector<double> sigma;
+  std::vector<double> delta;
+  std::vector<int> order; // Vertices in BFS order
+
+  std::vector<double> betweenness;
+  std::vector<double> farness;
+  std::vector<int> reach;
+};
+
+void
+brandes_worker::search(int s) {
+  // Count shortest paths from s.
+  order.clear();
+  order.push_back(s);
+  dist[s] = 0;
+  sigma[s] = 1;
+  for (std::size_t head = 0; head < order.size(); ++head) {
+    int v = order[head];
+    neighbors(v, [&](int w) {
+      if (dist[w] < 0) {
+        dist[w] = dist[v] + 1;
+        order.push_back(w);
+      }
+      if (dist[w] == dist[v] + 1)
+        sigma[w] += sigma[v];
+    });
+  }
+
+  // Accumulate dependencies in reverse BFS order. Only actors count as
+  // path endpoints, so movies pass dependency along without adding one.
+  for (std::size_t i = order.size(); i-- > 0; ) {
+    int v = order[i];
+    double dv = 0;
+    neighbors(v, [&](int w) {
+      if (dist[w] == dist[v] + 1)
+        dv += sigma[v] / sigma[w] * ((w < actors) + delta[w]);
+    });
+    delta[v] = dv;
+    if (v < actors && v != s) {
+      betweenness[v] += dv;
+      farness[v] += dist[v] / 2;
+      ++reach[v];
+    }
+  }
+
+  for (int v : order) {
+    dist[v] = -1;
+    sigma[v] = 0;
+    delta[v] = 0;
+  }
+}
+
+} // namespace
+
+void
+centrality::run(const database& db, int sample, int threads,
+                unsigned seed) {
+  auto start = std::chrono::steady_clock::now();
+  int n = db.actors.size();
+
+  std::vector<int> source(n);
+  std::iota(source.begin(), source.end(), 0);
+  if (sample > 0 && sample < n) {
+    std::mt19937 gen(seed);
+    std::shuffle(source.begin(), source.end(), gen);
+    source.resize(sample);
+  }
+  sources = source.size();
+
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // Threads take sources from a shared counter and keep their own sums.
+  simple_graph g(db);
+  std::vector<std::unique_ptr<brandes_worker>> workers;
+  for (int t = 0; t < threads; ++t)
+    workers.emplace_back(new brandes_worker(g));
+
+  std::atomic<int> next(0);
+  std::mutex report;
+  int step = std::max(1, sources / 20);
+  auto work = [&](brandes_worker& w) {
+    int i;
+    while ((i = next++) < sources) {
+      w.search(source[i]);
+      if (progress && (i + 1) % step == 0) {
+        std::lock_guard<std::mutex> lock(report);
+        *progress << "* centrality: " << i + 1 << '/' << sources
+                  << " sources\n";
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(work, std::ref(*workers[t]));
+  work(*workers[0]);
+  for (std::thread& t : pool)
+    t.join();
+
+  // Each unordered pair is seen from both ends when every actor is a
+  // source; a sample is scaled up to the full source count.
+  double scale = double(n) / std::max(1, sources) / 2;
+  betweenness.assign(n, 0);
+  closeness.assign(n, 0);
+  std::vector<double> farness(n, 0);
+  std::vector<int> reach(n, 0);
+  for (auto& w : workers) {
+    for (int v = 0; v < n; ++v) {
+      betweenness[v] += w->betweenness[v];
+      farness[v] += w->farness[v];
+      reach[v] += w->reach[v];
+    }
+  }
+  for (int v = 0; v < n; ++v) {
+    betweenness[v] *= scale;
+    if (farness[v] > 0)
+      closeness[v] = reach[v] / farness[v];
+  }
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
+
+std::vector<int>
+centrality::top(const std::vector<double>& score, int k) const {
+  std::vector<int> ids(score.size());
+  std::iota(ids.begin(), ids.end(), 0);
+  k = std::min<int>(k, ids.size());
+  std::partial_sort(ids.begin(), ids.begin() + k, ids.end(),
+                    [&](int a, int b) { return score[a] > score[b]; });
+  ids.resize(k);
+  return ids;
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_CENTRALITY_HPP
+#define IMDB_CENTRALITY_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// Betweenness and closeness centrality of actors.
+//
+// Betweenness is computed with Brandes' algorithm over the bipartite
+// actor-movie graph, counting only shortest paths between actors. Each
+// source actor is an independent search, so sources are spread across
+// threads, each with its own scratch buffers and accumulators, and the
+// per-thread scores are summed at the end.
+//
+// Closeness is the inverse of an actor's mean distance to the actors that
+// can reach it, accumulated from the same searches. When every actor is a
+// source both scores are exact. Otherwise a uniform sample of sources is
+// used and betweenness is scaled up to estimate the exact value.
+struct centrality
+{
+  // Runs the computation. A sample of 0 uses every actor as a source.
+  // A thread count of 0 uses all available cores.
+  void run(const database& db, int sample = 0, int threads = 0,
+           unsigned seed = 1);
+
+  // Returns the ids of the k actors with the highest scores.
+  std::vector<int> top(const std::vector<double>& score, int k) const;
+
+  std::vector<double> betweenness;
+  std::vector<double> closeness;
+
+  int sources = 0;
+  double seconds = 0;
+
+  // If set, progress is reported here every few percent of the sources.
+  std::ostream* progress = nullptr;
+};
+
+
+#endif
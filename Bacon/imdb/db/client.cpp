@@ -0,0 +1,57 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+// A command-line client for the db query daemon.
+//
+// Usage: db_client <socket> lookup|bacon|path <actor>
+//        db_client <socket> between <actor> <actor>
+
+#include "protocol.hpp"
+
+#include <iostream>
+#include <string>
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 4) {
+    std::cerr << "usage: db_client <socket> lookup|bacon|path <actor>\n"
+              << "       db_client <socket> between <actor> <actor>\n";
+    return 1;
+  }
+
+  std::string cmd = argv[2];
+  protocol::opcode op;
+  if (cmd == "lookup")
+    op = protocol::lookup;
+  else if (cmd == "bacon")
+    op = protocol::bacon;
+  else if (cmd == "path")
+    op = protocol::path;
+  else if (cmd == "between" && argc == 5)
+    op = protocol::between;
+  else {
+    std::cerr << "error: unknown command '" << cmd << "'\n";
+    return 1;
+  }
+
+  int fd = protocol::connect_unix(argv[1]);
+  if (fd < 0) {
+    std::cerr << "error: cannot connect to " << argv[1] << '\n';
+    return 1;
+  }
+
+  std::string reply;
+  std::string b = argc == 5 ? argv[4] : "";
+  if (!protocol::send(fd, protocol::request(op, argv[3], b)) ||
+      !protocol::receive(fd, reply) || reply.empty()) {
+    std::cerr << "error: connection lost\n";
+    return 1;
+  }
+  ::close(fd);
+
+  if (reply[0] != '+') {
+    std::cerr << "error: " << reply.substr(1) << '\n';
+    return 1;
+  }
+  std::cout << reply.substr(1) << '\n';
+}
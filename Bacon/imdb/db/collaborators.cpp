@@ -0,0 +1,161 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "collaborators.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+constexpr int chunk = 256;
+
+// Orders collaborators from most to least frequent.
+bool
+more_frequent(const collaborator& a, const collaborator& b) {
+  if (a.shared != b.shared)
+    return a.shared > b.shared;
+  return a.actor < b.actor;
+}
+
+// Counts co-appearances for one actor at a time. Each slot remembers the
+// last movie it was counted for, so a co-star playing several parts in a
+// movie is only counted once.
+struct counter
+{
+  struct slot
+  {
+    int actor = -1;
+    int shared;
+    int movie;
+  };
+
+  counter()
+    : slots(1024), mask(1023)
+  { }
+
+  void add(int a, int m) {
+    std::size_t i = hash(a);
+    while (slots[i].actor != -1 && slots[i].actor != a)
+      i = (i + 1) & mask;
+    slot& s = slots[i];
+    if (s.actor == -1) {
+      s.actor = a;
+      s.shared = 1;
+      s.movie = m;
+      used.push_back(i);
+      if (2 * used.size() > slots.size())
+        grow();
+    } else if (s.movie != m) {
+      ++s.shared;
+      s.movie = m;
+    }
+  }
+
+  // Empties the table, keeping its capacity.
+  void clear() {
+    for (std::size_t i : used)
+      slots[i].actor = -1;
+    used.clear();
+  }
+
+  std::size_t hash(int a) const {
+    return (static_cast<unsigned>(a) * 2654435761u) & mask;
+  }
+
+  void grow() {
+    std::vector<slot> old;
+    old.swap(slots);
+    slots.resize(2 * old.size());
+    mask = slots.size() - 1;
+    used.clear();
+    for (const slot& s : old) {
+      if (s.actor == -1)
+        continue;
+      std::size_t i = hash(s.actor);
+      while (slots[i].actor != -1)
+        i = (i + 1) & mask;
+      slots[i] = s;
+      used.push_back(i);
+    }
+  }
+
+  std::vector<slot> slots;
+  std::vector<std::size_t> used;
+  std::size_t mask;
+};
+
+} // namespace
+
+void
+collaborators::run(const database& db, int k, int threads) {
+  auto start = std::chrono::steady_clock::now();
+  int n = db.actors.size();
+  this->k = k;
+  table.assign(std::size_t(n) * k, collaborator{-1, 0});
+  length.assign(n, 0);
+
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::atomic<int> next(0);
+  std::atomic<long> total(0);
+  auto work = [&]() {
+    counter c;
+    std::vector<collaborator> heap;
+    std::vector<int> films;
+    long counted = 0;
+    int lo;
+    while ((lo = next.fetch_add(chunk)) < n) {
+      int hi = std::min(n, lo + chunk);
+      for (int a = lo; a < hi; ++a) {
+        // Visit each movie once, even if a plays several parts in it.
+        films.clear();
+        for (int x : db.actors[a].roles)
+          films.push_back(db.roles[x].movie);
+        std::sort(films.begin(), films.end());
+        films.erase(std::unique(films.begin(), films.end()), films.end());
+        for (int m : films) {
+          for (int r : db.movies[m].roles) {
+            int w = db.roles[r].actor;
+            if (w != a)
+              c.add(w, m);
+          }
+        }
+        counted += c.used.size();
+
+        // Keep the k best in a heap whose top is the worst of them.
+        heap.clear();
+        for (std::size_t i : c.used) {
+          collaborator x{c.slots[i].actor, c.slots[i].shared};
+          if ((int)heap.size() < k) {
+            heap.push_back(x);
+            std::push_heap(heap.begin(), heap.end(), more_frequent);
+          } else if (more_frequent(x, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), more_frequent);
+            heap.back() = x;
+            std::push_heap(heap.begin(), heap.end(), more_frequent);
+          }
+        }
+        std::sort_heap(heap.begin(), heap.end(), more_frequent);
+        std::copy(heap.begin(), heap.end(), table.begin() + std::size_t(a) * k);
+        length[a] = heap.size();
+        c.clear();
+      }
+    }
+    total += counted;
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(work);
+  work();
+  for (std::thread& t : pool)
+    t.join();
+
+  pairs = total;
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_COLLABORATORS_HPP
+#define IMDB_COLLABORATORS_HPP
+
+#include <vector>
+
+struct database;
+
+
+// A co-star and the number of movies shared with them.
+struct collaborator
+{
+  int actor;
+  int shared;
+};
+
+
+// The k most frequent co-stars of every actor.
+//
+// Actors are taken in chunks by a pool of threads. Each thread counts the
+// co-stars of one actor at a time in its own open-addressing table, which
+// is cleared by revisiting only the slots it used, and keeps the k best
+// counts in a bounded heap. The results go into a table with k slots per
+// actor, so a lookup afterwards is a copy of at most k entries.
+struct collaborators
+{
+  // Runs the computation. A thread count of 0 uses all available cores.
+  void run(const database& db, int k, int threads = 0);
+
+  // Returns true if the table has been computed.
+  bool ready() const { return !length.empty(); }
+
+  // The collaborators of a, most frequent first; ties go to the lower id.
+  const collaborator* begin(int a) const { return table.data() + a * k; }
+  int size(int a) const { return length[a]; }
+
+  int k = 0;
+  std::vector<collaborator> table;  // k slots per actor
+  std::vector<unsigned short> length; // Slots used by each actor
+  long pairs = 0; // Co-star pairs counted
+  double seconds = 0;
+};
+
+
+#endif
@@ -0,0 +1,226 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "communities.hpp"
+#include "db.hpp"
+#include "graph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+constexpr int block = 1024;
+constexpr int tally_size = 4; // Labels kept per movie
+
+std::uint64_t
+mix(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+typedef std::pair<int, int> vote; // Label and count
+
+// Sorts labels and replaces them with their counts, in label order.
+void
+count_labels(std::vector<int>& labels, std::vector<vote>& out) {
+  std::sort(labels.begin(), labels.end());
+  out.clear();
+  for (std::size_t i = 0; i < labels.size(); ) {
+    std::size_t j = i;
+    while (j < labels.size() && labels[j] == labels[i])
+      ++j;
+    out.push_back(vote(labels[i], j - i));
+    i = j;
+  }
+}
+
+} // namespace
+
+void
+communities::run(const database& db, unsigned seed, int max_iterations,
+                 int threads) {
+  auto start = std::chrono::steady_clock::now();
+  int n = db.actors.size();
+  int m = db.movies.size();
+  threads = thread_count(threads);
+
+  // Distinct movies of each actor, and distinct cast of each movie.
+  filmographies films;
+  films.build(db);
+  std::vector<int> cast_first(m + 1, 0);
+  for (int f : films.movies)
+    ++cast_first[f + 1];
+  for (int f = 0; f < m; ++f)
+    cast_first[f + 1] += cast_first[f];
+  std::vector<int> cast(films.movies.size());
+  std::vector<int> next(cast_first.begin(), cast_first.end() - 1);
+  for (int a = 0; a < n; ++a)
+    for (const int* p = films.begin(a); p != films.begin(a) + films.size(a); ++p)
+      cast[next[*p]++] = a;
+
+  label.resize(n);
+  for (int a = 0; a < n; ++a)
+    label[a] = a;
+  std::vector<int> moved(n);
+  std::vector<vote> tally(std::size_t(m) * tally_size);
+  std::vector<unsigned char> tally_len(m);
+  std::vector<int> changes(threads);
+
+  // Ties are broken by a seeded order that differs between the movie or
+  // actor choosing, so no label is favored everywhere.
+  auto rank = [&](int chooser, int l) {
+    return mix(seed ^ mix(std::uint64_t(chooser) << 32 | unsigned(l)));
+  };
+
+  iterations = 0;
+  while (iterations < max_iterations) {
+    // Tally the labels of each cast.
+    parallel_blocks(m, block, threads, [&](int lo, int hi, int) {
+      std::vector<int> labels;
+      std::vector<vote> votes;
+      for (int f = lo; f < hi; ++f) {
+        labels.clear();
+        for (int i = cast_first[f]; i < cast_first[f + 1]; ++i)
+          labels.push_back(label[cast[i]]);
+        count_labels(labels, votes);
+        int k = std::min<int>(tally_size, votes.size());
+        std::partial_sort(votes.begin(), votes.begin() + k, votes.end(),
+                          [&](const vote& x, const vote& y) {
+          if (x.second != y.second)
+            return x.second > y.second;
+          return rank(~f, x.first) < rank(~f, y.first);
+        });
+        std::copy(votes.begin(), votes.begin() + k,
+                  tally.begin() + std::size_t(f) * tally_size);
+        tally_len[f] = k;
+      }
+    });
+
+    // Half of the actors take the best label of their movies' tallies.
+    int parity = iterations & 1;
+    std::fill(changes.begin(), changes.end(), 0);
+    parallel_blocks(n, block, threads, [&](int lo, int hi, int t) {
+      std::vector<int> labels;
+      std::vector<vote> votes;
+      for (int a = lo; a < hi; ++a) {
+        moved[a] = label[a];
+        if (int(mix(seed + a) & 1) != parity || !films.size(a))
+          continue;
+
+        // Expand the tallies into (label, count) runs by label.
+        votes.clear();
+        for (const int* p = films.begin(a); p != films.begin(a) + films.size(a);
+             ++p) {
+          const vote* v = &tally[std::size_t(*p) * tally_size];
+          for (int i = 0; i < tally_len[*p]; ++i)
+            votes.push_back(vote(v[i].first,
+                                 v[i].second - (v[i].first == label[a])));
+        }
+        std::sort(votes.begin(), votes.end());
+        int best = label[a];
+        int best_score = 0;
+        bool stay = false; // The current label is among the best
+        for (std::size_t i = 0; i < votes.size(); ) {
+          int l = votes[i].first;
+          int score = 0;
+          for (; i < votes.size() && votes[i].first == l; ++i)
+            score += votes[i].second;
+          if (score > best_score) {
+            best = l;
+            best_score = score;
+            stay = l == label[a];
+          } else if (score == best_score && score > 0 && !stay) {
+            stay = l == label[a];
+            if (stay || rank(a, l) < rank(a, best))
+              best = l;
+          }
+        }
+        if (best_score > 0 && best != label[a]) {
+          moved[a] = best;
+          ++changes[t];
+        }
+      }
+    });
+    label.swap(moved);
+    ++iterations;
+
+    long changed = 0;
+    for (int c : changes)
+      changed += c;
+    if (changed * 1000 < n && iterations > 1)
+      break;
+  }
+
+  sizes.assign(n, 0);
+  for (int a = 0; a < n; ++a)
+    ++sizes[label[a]];
+  count = 0;
+  for (int s : sizes)
+    count += s != 0;
+
+  // Modularity of the projection, where each shared movie adds one to the
+  // weight of a pair of actors: Q = sum over communities c of
+  // L_c / W - (D_c / 2W)^2, with W the total weight, L_c the weight inside
+  // c, and D_c the weighted degree of c.
+  std::vector<double> inside(threads, 0);
+  parallel_blocks(m, block, threads, [&](int lo, int hi, int t) {
+    std::vector<int> labels;
+    std::vector<vote> votes;
+    for (int f = lo; f < hi; ++f) {
+      labels.clear();
+      for (int i = cast_first[f]; i < cast_first[f + 1]; ++i)
+        labels.push_back(label[cast[i]]);
+      count_labels(labels, votes);
+      for (const vote& v : votes)
+        inside[t] += 0.5 * v.second * (v.second - 1.0);
+    }
+  });
+  double total = 0;
+  std::vector<double> degree(n, 0);
+  for (int f = 0; f < m; ++f) {
+    double k = cast_first[f + 1] - cast_first[f];
+    total += 0.5 * k * (k - 1);
+    for (int i = cast_first[f]; i < cast_first[f + 1]; ++i)
+      degree[label[cast[i]]] += k - 1;
+  }
+  modularity = 0;
+  if (total > 0) {
+    for (double x : inside)
+      modularity += x / total;
+    for (double d : degree)
+      modularity -= (d / (2 * total)) * (d / (2 * total));
+  }
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
+
+void
+communities::report(std::ostream& os) const {
+  int largest = 0;
+  std::vector<int> buckets;
+  for (int s : sizes) {
+    if (!s)
+      continue;
+    largest = std::max(largest, s);
+    int b = 0;
+    while ((2 << b) <= s)
+      ++b;
+    if (b >= int(buckets.size()))
+      buckets.resize(b + 1);
+    ++buckets[b];
+  }
+  os << "* " << count << " communities after " << iterations << " rounds in "
+     << seconds << " s; modularity " << modularity << ", largest has "
+     << largest << " actors\n";
+  for (std::size_t b = 0; b < buckets.size(); ++b)
+    if (buckets[b])
+      os << "  size " << (1 << b) << '-' << (2 << b) - 1 << ": "
+         << buckets[b] << '\n';
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_COMMUNITIES_HPP
+#define IMDB_COMMUNITIES_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// Communities of the co-appearance graph, found by label propagation.
+//
+// Every actor starts in a community of their own and repeatedly joins the
+// community most common among their co-stars, counted once per shared
+// movie. Counting co-stars pair by pair would cost the square of each
+// cast, so labels are propagated through the movies instead: each movie
+// tallies the labels of its cast and keeps the few most common, and an
+// actor sums the tallies of their movies, less their own vote. For casts
+// with more labels than a tally keeps, the rarest are ignored.
+//
+// Half of the actors, chosen by the seed, move in each round, reading the
+// labels of the previous round. The result depends only on the seed, not
+// on the number of threads or their timing. Ties go to the actor's current
+// community, then to a seeded choice.
+struct communities
+{
+  // Runs until fewer than one actor in a thousand moves in a round, or for
+  // at most max_iterations rounds. A thread count of 0 uses all available
+  // cores.
+  void run(const database& db, unsigned seed = 1, int max_iterations = 30,
+           int threads = 0);
+
+  // Prints the number of communities, modularity, and sizes.
+  void report(std::ostream& os) const;
+
+  std::vector<int> label; // Community of each actor, named by an actor
+  std::vector<int> sizes; // Community sizes, indexed by label
+  int count = 0;
+  int iterations = 0;
+  double modularity = 0; // Of the co-appearance graph, weighted by movies
+  double seconds = 0;
+};
+
+
+#endif
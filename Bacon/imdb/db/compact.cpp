@@ -0,0 +1,152 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "compact.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+// Returns the actors with the most roles, which make the slowest searches.
+std::vector<int>
+busiest(const database& db, int k) {
+  std::vector<int> a(db.actors.size());
+  for (int i = 0; i < db.actors.size(); ++i)
+    a[i] = i;
+  k = std::min<int>(k, a.size());
+  std::partial_sort(a.begin(), a.begin() + k, a.end(), [&](int x, int y) {
+    return db.actors[x].roles.size() > db.actors[y].roles.size();
+  });
+  a.resize(k);
+  return a;
+}
+
+} // namespace
+
+void
+compact_graph::build(database& db) {
+  auto start = std::chrono::steady_clock::now();
+  int n = db.actors.size();
+  int m = db.movies.size();
+
+  // Number the productions. Episodes go to their series, which may not be
+  // in the movie list; such series are numbered when first seen.
+  production.assign(m, -1);
+  prod_movie.clear();
+  std::unordered_map<std::string, int> unlisted;
+  for (int i = 0; i < m; ++i) {
+    if (db.movies[i].kind != kind_episode) {
+      production[i] = prod_movie.size();
+      prod_movie.push_back(i);
+    }
+  }
+  for (int i = 0; i < m; ++i) {
+    if (db.movies[i].kind != kind_episode)
+      continue;
+    const std::string& name = db.movies[i].name;
+    std::string series = name.substr(0, name.find(" {"));
+    int s = db.movie_lookup.find(series.c_str());
+    if (s != -1 && db.movies[s].kind != kind_episode) {
+      production[i] = production[s];
+      continue;
+    }
+    auto iter = unlisted.emplace(series, prod_movie.size());
+    if (iter.second)
+      prod_movie.push_back(i);
+    production[i] = iter.first->second;
+  }
+  int p = prod_movie.size();
+
+  // Merge the roles of each actor by production.
+  actor_first.assign(1, 0);
+  actor_first.reserve(n + 1);
+  actor_prod.clear();
+  actor_mult.clear();
+  std::vector<int> prods;
+  std::vector<int> count(p + 1, 0);
+  for (int a = 0; a < n; ++a) {
+    prods.clear();
+    for (int x : db.actors[a].roles)
+      prods.push_back(production[db.roles[x].movie]);
+    std::sort(prods.begin(), prods.end());
+    for (std::size_t i = 0; i < prods.size(); ) {
+      std::size_t j = i;
+      while (j < prods.size() && prods[j] == prods[i])
+        ++j;
+      actor_prod.push_back(prods[i]);
+      actor_mult.push_back(j - i);
+      ++count[prods[i] + 1];
+      i = j;
+    }
+    actor_first.push_back(actor_prod.size());
+  }
+
+  // The reverse edges.
+  prod_first.assign(p + 1, 0);
+  for (int i = 0; i < p; ++i)
+    prod_first[i + 1] = prod_first[i] + count[i + 1];
+  prod_actor.resize(actor_prod.size());
+  std::vector<int> next(prod_first.begin(), prod_first.end() - 1);
+  for (int a = 0; a < n; ++a)
+    for (int i = actor_first[a]; i < actor_first[a + 1]; ++i)
+      prod_actor[next[actor_prod[i]]++] = a;
+
+  roles = db.roles.size();
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+
+  // Time searches from the same centers on both graphs.
+  std::vector<int> centers = busiest(db, 4);
+  auto t0 = std::chrono::steady_clock::now();
+  for (int c : centers)
+    db.explore(c);
+  auto t1 = std::chrono::steady_clock::now();
+  std::vector<int> dist;
+  for (int c : centers)
+    search(c, dist);
+  auto t2 = std::chrono::steady_clock::now();
+  std::size_t k = std::max<std::size_t>(1, centers.size());
+  before = std::chrono::duration<double>(t1 - t0).count() / k;
+  after = std::chrono::duration<double>(t2 - t1).count() / k;
+}
+
+void
+compact_graph::search(int c, std::vector<int>& dist) const {
+  dist.assign(actors(), -1);
+  std::vector<bool> seen(productions(), false);
+  std::vector<int> queue;
+  queue.reserve(actors());
+  queue.push_back(c);
+  dist[c] = 0;
+  for (std::size_t head = 0; head < queue.size(); ++head) {
+    int u = queue[head];
+    for (int i = actor_first[u]; i < actor_first[u + 1]; ++i) {
+      int f = actor_prod[i];
+      if (seen[f])
+        continue;
+      seen[f] = true;
+      for (int j = prod_first[f]; j < prod_first[f + 1]; ++j) {
+        int w = prod_actor[j];
+        if (dist[w] == -1) {
+          dist[w] = dist[u] + 1;
+          queue.push_back(w);
+        }
+      }
+    }
+  }
+}
+
+void
+compact_graph::report(std::ostream& os) const {
+  int edges = actor_prod.size();
+  os << "* compacted " << roles << " roles to " << edges << " edges ("
+     << 100.0 * (roles - edges) / std::max(1, roles) << "% fewer) and "
+     << production.size() << " movies to " << productions()
+     << " productions in " << seconds << " s\n"
+     << "* search " << before * 1e3 << " ms -> " << after * 1e3 << " ms ("
+     << before / after << "x)\n";
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_COMPACT_HPP
+#define IMDB_COMPACT_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// A smaller view of the actor graph for series-level questions.
+//
+// A series actor has one role per episode, so one working relationship
+// can put hundreds of roles in an actor's filmography and as many episode
+// vertices in every search. Here each episode is folded into its parent
+// series ("Show" (2012) {Ep 1 (1.1)} becomes "Show" (2012)), and all the
+// roles of an actor in one production become a single edge that records
+// how many roles it stands for.
+//
+// Folding changes who counts as a co-star: actors in different episodes of
+// a series are one step apart here, so distances are series-level, not
+// the episode-level distances of the database.
+struct compact_graph
+{
+  // Builds the view and times searches against the full graph.
+  void build(database& db);
+
+  // Returns true if the view has been built.
+  bool ready() const { return !actor_first.empty(); }
+
+  // Stores the distance of every actor from c in dist; -1 if unreachable.
+  void search(int c, std::vector<int>& dist) const;
+
+  void report(std::ostream& os) const;
+
+  int actors() const { return actor_first.size() - 1; }
+  int productions() const { return prod_first.size() - 1; }
+
+  // The production of each movie, and a movie naming each production.
+  std::vector<int> production;
+  std::vector<int> prod_movie;
+
+  // Edges from actors to productions and back. mult is the number of roles
+  // an edge stands for.
+  std::vector<int> actor_first;
+  std::vector<int> actor_prod;
+  std::vector<int> actor_mult;
+  std::vector<int> prod_first;
+  std::vector<int> prod_actor;
+
+  int roles = 0; // Edges before compaction
+  double seconds = 0;
+  double before = 0; // Seconds per search of the full graph
+  double after = 0;  // Seconds per search of this view
+};
+
+
+#endif
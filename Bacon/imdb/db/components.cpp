@@ -0,0 +1,157 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "components.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <thread>
+
+namespace {
+
+// Returns the root of a, halving the path as it goes. Concurrent halving
+// is safe because it only ever replaces a parent with an ancestor.
+int
+find(std::vector<std::atomic<int>>& parent, int a) {
+  while (true) {
+    int p = parent[a].load(std::memory_order_relaxed);
+    if (p == a)
+      return a;
+    int g = parent[p].load(std::memory_order_relaxed);
+    if (p != g)
+      parent[a].compare_exchange_weak(p, g, std::memory_order_relaxed);
+    a = g;
+  }
+}
+
+// Links the roots of a and b, always under the smaller id. If another
+// thread changes a root first, the roots are found again.
+void
+unite(std::vector<std::atomic<int>>& parent, int a, int b) {
+  while (true) {
+    a = find(parent, a);
+    b = find(parent, b);
+    if (a == b)
+      return;
+    if (a < b)
+      std::swap(a, b);
+    int expected = a;
+    if (parent[a].compare_exchange_strong(expected, b))
+      return;
+  }
+}
+
+} // namespace
+
+void
+components::run(const database& db, int threads) {
+  auto start = std::chrono::steady_clock::now();
+  int n = db.actors.size();
+  int m = db.movies.size();
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<std::atomic<int>> parent(n);
+  for (int a = 0; a < n; ++a)
+    parent[a].store(a, std::memory_order_relaxed);
+
+  // Every actor in a cast joins the first actor in it.
+  const int chunk = 4096;
+  std::atomic<int> cursor(0);
+  auto work = [&]() {
+    int lo;
+    while ((lo = cursor.fetch_add(chunk)) < m) {
+      int hi = std::min(m, lo + chunk);
+      for (int f = lo; f < hi; ++f) {
+        const std::vector<int>& cast = db.movies[f].roles;
+        for (std::size_t i = 1; i < cast.size(); ++i)
+          unite(parent, db.roles[cast[0]].actor, db.roles[cast[i]].actor);
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(work);
+  work();
+  for (std::thread& t : pool)
+    t.join();
+
+  // Label each actor with its root and thread the members of each
+  // component into a cycle.
+  label.assign(n, 0);
+  sizes.assign(n, 0);
+  next.assign(n, 0);
+  std::vector<int> last(n, -1);
+  count = 0;
+  for (int a = 0; a < n; ++a) {
+    int r = find(parent, a);
+    label[a] = r;
+    if (sizes[r]++ == 0)
+      ++count;
+    next[a] = r;
+    if (last[r] != -1)
+      next[last[r]] = a;
+    last[r] = a;
+  }
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
+
+// Adds a new actor in a component of its own.
+void
+components::add_actor() {
+  int a = label.size();
+  label.push_back(a);
+  sizes.push_back(1);
+  next.push_back(a);
+  ++count;
+}
+
+// Merges the components of a and b, relabeling the smaller one.
+void
+components::join(int a, int b) {
+  int ra = label[a], rb = label[b];
+  if (ra == rb)
+    return;
+  if (sizes[ra] < sizes[rb])
+    std::swap(ra, rb);
+  int x = rb;
+  do {
+    label[x] = ra;
+    x = next[x];
+  } while (x != rb);
+  std::swap(next[ra], next[rb]);
+  sizes[ra] += sizes[rb];
+  sizes[rb] = 0;
+  --count;
+}
+
+// Writes the number of components, the size of the giant component, and
+// the distribution of component sizes in powers of two.
+void
+components::report(std::ostream& os) const {
+  int n = label.size();
+  int giant = 0;
+  std::vector<int> buckets;
+  for (int r = 0; r < n; ++r) {
+    if (!sizes[r])
+      continue;
+    giant = std::max(giant, sizes[r]);
+    int b = 0;
+    while ((2 << b) <= sizes[r])
+      ++b;
+    if (b >= int(buckets.size()))
+      buckets.resize(b + 1);
+    ++buckets[b];
+  }
+  os << "* " << count << " components in " << seconds << " s; giant has "
+     << giant << " actors (" << (n ? 100.0 * giant / n : 0) << "%)\n";
+  for (std::size_t b = 0; b < buckets.size(); ++b)
+    if (buckets[b])
+      os << "  size " << (1 << b) << '-' << (2 << b) - 1 << ": "
+         << buckets[b] << '\n';
+}
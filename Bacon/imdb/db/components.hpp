@@ -0,0 +1,49 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_COMPONENTS_HPP
+#define IMDB_COMPONENTS_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// Connected components of the actor graph.
+//
+// Components are found with a concurrent union-find: threads take ranges
+// of movies and union the cast of each, linking roots with compare-and-
+// swap. Afterwards every actor is labeled with the representative of its
+// component, so reachability and component sizes are answered in constant
+// time.
+//
+// Roles added after the pass merge components by relabeling the smaller
+// of the two.
+struct components
+{
+  void run(const database& db, int threads = 0);
+
+  // Returns true if the components have been computed.
+  bool ready() const { return !label.empty(); }
+
+  // Returns true if there is a path between actors a and b.
+  bool connected(int a, int b) const { return label[a] == label[b]; }
+
+  // Returns the number of actors in the component of a.
+  int size_of(int a) const { return sizes[label[a]]; }
+
+  void add_actor();
+  void join(int a, int b);
+
+  void report(std::ostream& os) const;
+
+  std::vector<int> label; // Representative of each actor's component
+  std::vector<int> sizes; // Component size, indexed by representative
+  std::vector<int> next;  // Members of a component form a cycle
+  int count = 0; // Number of components
+  double seconds = 0;
+};
+
+
+#endif
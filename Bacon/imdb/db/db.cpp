@@ -6,13 +6,43 @@
 //Project done in association with Adam Browne
 
 #include "db.hpp"
+#include "intersect.hpp"
+#include "metrics.hpp"
+#include "landmarks.hpp"
+#include "pagerank.hpp"
+#include "centrality.hpp"
+#include "collaborators.hpp"
+#include "communities.hpp"
+#include "compact.hpp"
+#include "levels.hpp"
+#include "reorder.hpp"
+#include "history.hpp"
+#include "filter.hpp"
+#include "diameter.hpp"
+#include "estimate.hpp"
+#include "export.hpp"
+#include "paths.hpp"
+#include "weighted.hpp"
+#include "batch.hpp"
+#include "query.hpp"
+#include "server.hpp"
+#include "loader.hpp"
 
-#include "../imdb/actor_parser.hpp"
-#include "../imdb/movie_parser.hpp"
-
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <queue>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
 
 database::database() {
   // Pre-allocate a bunch of storage for these things.
@@ -33,6 +63,7 @@ database::add_movie(const char* name, const char* year) {
 
 int
 database::find_movie(const char* name) {
+  IMDB_TIME(lookup);
   return movie_lookup.find(name);
 }
 
@@ -41,12 +72,28 @@ int
 database::add_actor(const char* name) {
   int id = actors.emplace(name);
   actor_lookup.emplace(actors[id].name.c_str(), id);
+  ++generation;
+
+  // New actors start out unreachable.
+  if (dynamic && center != -1) {
+    distance.push_back(-1);
+    path.emplace_back();
+  }
+  if (parts.ready())
+    parts.add_actor();
+
+  // Cached searches do not cover the new actor.
+  if (cache.size())
+    cache.clear();
+  if (films.ready())
+    films.clear();
   return id;
 }
 
 // Returns the row id of an actor with the given name.
 int
 database::find_actor(const char* name) {
+  IMDB_TIME(lookup);
   return actor_lookup.find(name);
 }
 
@@ -73,21 +120,137 @@ database::add_role(const char* act, const char* mov, const char* info) {
   int id = roles.emplace(a, m, info);
   actors[a].add_role(id);
   movies[m].add_role(id);
+  ++generation;
+
+  // The new role may join two components.
+  if (parts.ready())
+    parts.join(a, roles[movies[m].roles[0]].actor);
+
+  // Cached searches no longer describe the graph.
+  if (cache.size())
+    cache.clear();
+  if (films.ready())
+    films.clear();
+
+  // Pass any shorter paths through the new role on to the rest of the
+  // graph.
+  if (dynamic && center != -1) {
+    std::vector<std::vector<int>> q;
+    relax(a, m, q);
+    propagate(q);
+  }
   return id;
 }
 
+// Adds a batch of roles, updating distances once for the whole batch
+// instead of once per role. Returns the number of roles added.
+int
+database::add_roles(const std::vector<role_update>& rows) {
+  bool was_dynamic = dynamic;
+  dynamic = false;
+  std::vector<int> added;
+  for (const role_update& r : rows) {
+    if (find_actor(r.actor) == -1)
+      add_actor(r.actor.c_str());
+    int id = add_role(r.actor.c_str(), r.movie.c_str(), r.info.c_str());
+    if (id != -1)
+      added.push_back(id);
+  }
+  dynamic = was_dynamic;
+
+  if (dynamic && center != -1) {
+    distance.resize(actors.size(), -1);
+    path.resize(actors.size());
+    std::vector<std::vector<int>> q;
+    for (int id : added)
+      relax(roles[id].actor, roles[id].movie, q);
+    propagate(q);
+  }
+  return added.size();
+}
+
+//Returns true if the actor has been reached from the center
+bool database::reached(int a) const
+{
+  return distance[a] >= 0;
+}
+
+//Lowers the distance of actor w to d, reached from actor u through the
+//given film. Improved actors are queued by distance so that the change
+//can be passed on to their co-stars.
+void database::improve(int w, int u, int film, int d,
+                       std::vector<std::vector<int>>& q)
+{
+  if(reached(w) && distance[w] <= d)
+    return;
+  distance[w] = d;
+  path[w] = Vertex(actors[u], u, movies[film].name);
+  if(int(q.size()) <= d)
+    q.resize(d + 1);
+  q[d].push_back(w);
+  ++dynamic_updates;
+}
+
+//Seeds the improvements made possible by a new role linking actor a and
+//the given film: a may now be closer through its new co-stars, and they
+//may be closer through a.
+void database::relax(int a, int film, std::vector<std::vector<int>>& q)
+{
+  for(int i : movies[film].roles)
+  {
+    int u = roles[i].actor;
+    if(u != a && reached(u))
+      improve(a, u, film, distance[u] + 1, q);
+  }
+  if(!reached(a))
+    return;
+  for(int i : movies[film].roles)
+  {
+    int w = roles[i].actor;
+    if(w != a)
+      improve(w, a, film, distance[a] + 1, q);
+  }
+}
+
+//Processes queued actors in order of distance. Every actor is expanded
+//at most once, at its final distance; stale queue entries are skipped.
+void database::propagate(std::vector<std::vector<int>>& q)
+{
+  for(std::size_t d = 0; d < q.size(); ++d)
+  {
+    for(std::size_t j = 0; j < q[d].size(); ++j)
+    {
+      int u = q[d][j];
+      if(distance[u] != int(d))
+        continue;
+      for(int x : actors[u].roles)
+      {
+        int film = roles[x].movie;
+        for(int i : movies[film].roles)
+          improve(roles[i].actor, u, film, d + 1, q);
+      }
+    }
+  }
+}
+
 //Computes Bacon Numbers for actos and stores distance in a vector
 void database::BaconNumber()
 {
-  int BacNum = find_actor("Bacon, Kevin (I)");
-  auto bacon = actors[BacNum];
+  BaconNumber(find_actor(default_center));
+}
+
+//Computes distances from the given center actor and stores them in a vector
+void database::BaconNumber(int c)
+{
+  auto bacon = actors[c];
+  center = c;
 
   //accumulates kevin bacon numbers & stores paths
   path = std::vector<Vertex>(actors.size());
-  distance = std::vector<int>(actors.size(), 0);
+  distance = std::vector<int>(actors.size(), -1);
 
   //run the BFS
-  BFS(Vertex(bacon, BacNum));
+  BFS(Vertex(bacon, c));
 
 }
 
@@ -140,20 +303,208 @@ void database::BFS(Vertex v)
   }
 }
 
+//Returns a compact search result for the given center. Results are kept
+//in an LRU cache, so repeated queries against popular centers only cost
+//a walk along the path.
+bfs_ptr database::search(int c)
+{
+  IMDB_TIME(search);
+  if (bfs_ptr hit = cache.find(c))
+    return hit;
+  bfs_ptr r = explore(c);
+  cache.insert(r);
+  return r;
+}
+
+//Admits every movie. Searches instantiated with this mask compile the
+//movie test away, so the unfiltered search pays nothing for filtering.
+struct any_movie
+{
+  bool test(int) const { return true; }
+};
+
+//Runs a breadth-first search from the given center over the movies
+//admitted by the mask.
+template<typename Mask>
+static std::shared_ptr<bfs_result>
+explore_with(database& db, int c, const Mask& mask)
+{
+  IMDB_TIME(bfs);
+  auto r = std::make_shared<bfs_result>(c, db.actors.size());
+  std::vector<bool> VisitedMovie(db.movies.size(), false);
+
+  //the queue holds actor ids; the distance doubles as the visited mark
+  std::vector<int> Queue;
+  Queue.reserve(db.actors.size());
+  Queue.push_back(c);
+  r->distance[c] = 0;
+  for(std::size_t head = 0; head < Queue.size(); ++head)
+  {
+    int target = Queue[head];
+    unsigned char next = byte_distance(r->distance[target] + 1);
+    for(int x : db.actors[target].roles)
+    {
+      int film = db.roles[x].movie;
+      if(VisitedMovie[film] || !mask.test(film))
+        continue;
+      VisitedMovie[film] = true;
+      for(int i : db.movies[film].roles)
+      {
+        int actorkey = db.roles[i].actor;
+        if(r->distance[actorkey] == unreachable)
+        {
+          r->distance[actorkey] = next;
+          r->parent[actorkey] = x;
+          Queue.push_back(actorkey);
+        }
+      }
+    }
+  }
+  IMDB_COUNT(actors_visited, Queue.size());
+
+  return r;
+}
+
+//Returns the exact distance between two actors using a bidirectional
+//search. Each round expands one full level of the smaller frontier, and
+//the search stops at the first level on which the two sides meet.
+template<typename Mask>
+static int
+distance_with(database& db, int a, int b, const Mask& mask, meet_scratch& s)
+{
+  IMDB_TIME(meet);
+  if(a == b) return 0;
+
+  //per-side distances and visited movies; side 0 grows from a, 1 from b
+  s.start(db.actors.size(), db.movies.size());
+  std::vector<int> Frontier[2] = {{a}, {b}};
+  s.reach(0, a, 0);
+  s.reach(1, b, 0);
+
+  while(!Frontier[0].empty() && !Frontier[1].empty())
+  {
+    int side = Frontier[0].size() <= Frontier[1].size() ? 0 : 1;
+    std::vector<int> next;
+    int best = -1;
+    for(int target : Frontier[side])
+    {
+      int here = s.distance(side, target);
+      for(int x : db.actors[target].roles)
+      {
+        int film = db.roles[x].movie;
+        if(!mask.test(film) || !s.visit(side, film))
+          continue;
+        for(int i : db.movies[film].roles)
+        {
+          int actorkey = db.roles[i].actor;
+          int there = s.distance(1 - side, actorkey);
+          if(there != -1)
+          {
+            int d = here + 1 + there;
+            if(best == -1 || d < best)
+              best = d;
+          }
+          if(s.distance(side, actorkey) == -1)
+          {
+            s.reach(side, actorkey, here + 1);
+            next.push_back(actorkey);
+          }
+        }
+      }
+    }
+    if(best != -1)
+      return best;
+    Frontier[side].swap(next);
+  }
+  return -1;
+}
+
+//Begins a new search. Marks from earlier searches are stale once the
+//epoch moves past them, and are only cleared when it wraps around.
+void meet_scratch::start(int actors, int movies)
+{
+  if(++epoch == 0 || mark[0].size() != std::size_t(actors) ||
+     film[0].size() != std::size_t(movies))
+  {
+    for(int side = 0; side < 2; ++side)
+    {
+      mark[side].assign(actors, 0);
+      dist[side].resize(actors);
+      film[side].assign(movies, 0);
+    }
+    epoch = 1;
+  }
+}
+
+//Runs a breadth-first search from the given center, bypassing the cache.
+std::shared_ptr<bfs_result> database::explore(int c)
+{
+  return explore_with(*this, c, any_movie());
+}
+
+//Runs a breadth-first search using only the movies in the mask. Filtered
+//results are never cached.
+std::shared_ptr<bfs_result> database::explore(int c, const movie_mask& mask)
+{
+  return explore_with(*this, c, mask);
+}
+
+//Returns the exact distance between two actors, or -1 if there is none
+int database::distance_between(int a, int b)
+{
+  meet_scratch s;
+  return distance_with(*this, a, b, any_movie(), s);
+}
+
+//Returns the exact distance between two actors, reusing the scratch space
+//of earlier searches
+int database::distance_between(int a, int b, meet_scratch& scratch)
+{
+  return distance_with(*this, a, b, any_movie(), scratch);
+}
+
+//Returns the exact distance between two actors using only the movies in
+//the mask
+int database::distance_between(int a, int b, const movie_mask& mask)
+{
+  meet_scratch s;
+  return distance_with(*this, a, b, mask, s);
+}
+
+//Returns the movies both actors appear in, in id order
+std::vector<int> database::common_movies(int a, int b)
+{
+  IMDB_TIME(common);
+  if(!films.ready()) films.build(*this);
+  std::vector<int> out(std::min(films.size(a), films.size(b)));
+  out.resize(intersect(films.begin(a), films.size(a),
+                       films.begin(b), films.size(b), out.data()));
+  return out;
+}
+
+//Returns the number of movies both actors appear in
+int database::costar_count(int a, int b)
+{
+  IMDB_TIME(common);
+  if(!films.ready()) films.build(*this);
+  return intersect_count(films.begin(a), films.size(a),
+                         films.begin(b), films.size(b));
+}
+
 //Display co-stars and movies along the path from Kevin bacon and target
 int database::Display(const std::string& actor)
 {
   int target = find_actor(actor);
-  if(target == -1) return -1;
+  if(target == -1 || distance[target] < 0) return -1;
+  IMDB_TIME(output);
   int current = target;
-  int kb = find_actor("Bacon, Kevin (I)"); //Find index of Kevin Bacon
   std::cout << actors[current].name + " starred in "; //Line for target actor
 
-  //Loop to find print the path from target to Kevin Bacon
-  while(current != kb)
+  //Loop to find print the path from target to the center
+  while(current != center)
   {
     auto previous = path[current];
-    if (previous.star.name == "Bacon, Kevin (I)")
+    if (previous.key == center)
       std::cout << previous.name << " with " << previous.star.name;
     else
       std::cout << previous.name << " with " << previous.star.name
@@ -165,86 +516,980 @@ int database::Display(const std::string& actor)
   return distance[target];
 }
 
-
-struct movie_visitor
+//Display co-stars and movies along the path from the given center and
+//target. Centers other than the current one are answered from the cache.
+int database::Display(const std::string& actor, const std::string& name)
 {
-  movie_visitor(database& db)
-    : db(db)
-  { }
+  int c = find_actor(name);
+  if(c == -1) return -1;
+  if(c == center) return Display(actor);
 
-  // Nothing to do.
-  void on_movie(const char* m) { }
-
-  // Save each movie.
-  void on_row(const char* n, const char* y) {
-    db.add_movie(n, y);
-  }
+  int target = find_actor(actor);
+  if(target == -1) return -1;
+  return Display(target, *search(c));
+}
 
-  database& db;
-};
+//Display the path from the given center and target using only the movies
+//accepted by the filter.
+int database::Display(const std::string& actor, const std::string& name,
+                      const movie_filter& filter)
+{
+  int c = find_actor(name);
+  int target = find_actor(actor);
+  if(c == -1 || target == -1) return -1;
+  return Display(target, *explore(c, movie_mask(movies, filter)));
+}
 
-struct actor_visitor
+//Display the path recorded for target in a compact search result.
+int database::Display(int target, const bfs_result& r)
 {
-  actor_visitor(database& db)
-    : db(db)
-  { }
+  if(r.distance[target] == unreachable) return -1;
 
-  void on_actor(const char* n) {
-    db.add_actor(n);
+  //collect the links first so that walking and printing are timed apart
+  std::vector<int> links;
+  {
+    IMDB_TIME(path);
+    for(int current = target; current != r.center;
+        current = roles[links.back()].actor)
+      links.push_back(r.parent[current]);
   }
 
-  void on_row(const char* act, const char* mov, const char* info) {
-    db.add_role(act, mov, info);
+  IMDB_TIME(output);
+  std::cout << actors[target].name + " starred in ";
+  for(int x : links)
+  {
+    const role& previous = roles[x];
+    std::cout << movies[previous.movie].name << " with "
+              << actors[previous.actor].name;
+    if (previous.actor != r.center)
+      std::cout << " who starred in ";
   }
+  std::cout << std::endl;
+  return r.distance[target];
+}
 
-  database& db;
-};
 
+// Parses the name of a vertex order.
+static bool
+parse_order(const std::string& s, vertex_order& k) {
+  if (s == "degree")
+    k = vertex_order::degree;
+  else if (s == "bfs")
+    k = vertex_order::bfs;
+  else if (s == "rcm")
+    k = vertex_order::rcm;
+  else
+    return false;
+  return true;
+}
+
+// Prints the closest actor names to a name that was not found.
+static void
+suggest(const database& db, const std::string& name, std::ostream& os) {
+  std::vector<name_match> m = db.actor_names.find(name, 3);
+  for (std::size_t i = 0; i < m.size(); ++i)
+    os << (i ? ", " : "  did you mean: ") << db.actors[m[i].id].name;
+  if (!m.empty())
+    os << '\n';
+}
+
+// Reads a number from the front of a command's arguments, removing it and
+// the spaces after it. Returns false, leaving s alone, if there is none or
+// if the arguments are an actor's whole name, so that names starting with
+// digits are not taken apart.
+static bool
+take_number(database& db, std::string& s, double& x) {
+  if (db.find_actor(s) != -1)
+    return false;
+  char* end;
+  double t = std::strtod(s.c_str(), &end);
+  if (end == s.c_str() || (*end != 0 && *end != ' '))
+    return false;
+  x = t;
+  s.erase(0, end - s.c_str());
+  s.erase(0, std::min(s.size(), s.find_first_not_of(' ')));
+  return true;
+}
+
+static int
+usage() {
+  std::cerr << "usage: db [--reorder degree|bfs|rcm] [--batch <file>|-]\n"
+            << "          [--output <file>] [--serve <socket>]"
+            << " [--threads <n>]\n"
+            << "          [--export <prefix> [--format edges|csr]"
+            << " [--costars yes|no]]\n";
+  return 1;
+}
+
+// Usage: db [--reorder degree|bfs|rcm] [--batch <file>|-]
+//           [--output <file>] [--serve <socket>] [--threads <n>]
+//           [--export <prefix> [--format edges|csr] [--costars yes|no]]
+//
+// The data files are read from the current directory. With --batch, the
+// Bacon numbers and paths of the actors named on each line of the file (or
+// standard input) are written to standard output or the --output file, and
+// the program exits instead of starting the shell. With --serve, queries
+// are answered on the given Unix domain socket instead (see server.hpp).
+// With --export, the graph is written to binary files named by the prefix
+// as an edge list or in CSR form, with co-star edges if asked for (see
+// export.hpp).
 int
 main(int argc, char* argv[]) {
   database db;
 
-  // Actually parse the content.
-  movie_visitor movie_vis(db);
-  actor_visitor actor_vis(db);
+  vertex_order order;
+  bool reordered = false;
+  const char* batch = nullptr;
+  const char* output = nullptr;
+  const char* socket = nullptr;
+  const char* prefix = nullptr;
+  export_format format = export_format::edges;
+  bool costars = false;
+  int threads = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 == argc)
+      return usage();
+    if (arg == "--reorder" && parse_order(argv[i + 1], order))
+      reordered = true;
+    else if (arg == "--batch")
+      batch = argv[i + 1];
+    else if (arg == "--output")
+      output = argv[i + 1];
+    else if (arg == "--serve")
+      socket = argv[i + 1];
+    else if (arg == "--threads")
+      threads = std::atoi(argv[i + 1]);
+    else if (arg == "--export")
+      prefix = argv[i + 1];
+    else if (arg == "--format" && !std::strcmp(argv[i + 1], "edges"))
+      format = export_format::edges;
+    else if (arg == "--format" && !std::strcmp(argv[i + 1], "csr"))
+      format = export_format::csr;
+    else if (arg == "--costars" && !std::strcmp(argv[i + 1], "yes"))
+      costars = true;
+    else if (arg == "--costars" && !std::strcmp(argv[i + 1], "no"))
+      costars = false;
+    else
+      return usage();
+    ++i;
+  }
+
+  // Keep standard output clean for batch results.
+  std::ostream& log = batch && !output ? std::cerr : std::cout;
 
-  imdb::movie_parser<movie_visitor> movie_parser("movies.list", movie_vis);
-  imdb::actor_parser<actor_visitor> actor_parser("actors.list", actor_vis);
-  imdb::actor_parser<actor_visitor> actress_parser("actresses.list", actor_vis);
+  // Load in the background. Batch and server modes need the whole graph
+  // before they start; the shell answers what it can in the meantime.
+  loader load(db);
+  load.start(log, reordered ? &order : nullptr, !batch && !socket && !prefix);
+  if (batch || socket || prefix) {
+    load.wait();
+    if (load.failed()) {
+      std::cerr << load.error << '\n';
+      return 1;
+    }
+  }
 
-  std::cout << "* loading movies\n";
-  movie_parser.parse();
-  std::cout << "* loaded " << db.movies.size() << " movies\n";
+  // Get the target actor (Kevin Bacon).
+  const char* kb = default_center;
 
-  std::cerr << "* loading actors\n";
-  actor_parser.parse();
-  std::cout << "* loading actresses\n";
-  actress_parser.parse();
-  std::cout << "* loaded " << db.actors.size() << " actors\n";
+  if (batch) {
+    int target = db.find_actor(kb);
+    std::vector<std::string> names;
+    std::ifstream file;
+    if (std::strcmp(batch, "-")) {
+      file.open(batch);
+      if (!file.is_open()) {
+        std::cerr << "error: cannot open '" << batch << "'\n";
+        return 1;
+      }
+    }
+    std::istream& in = std::strcmp(batch, "-") ? file : std::cin;
+    std::string name;
+    while (std::getline(in, name))
+      names.push_back(name);
 
-  // Diagnose lookup errors. These happens when an actor row refers
-  // to a movie title that was not parsed in the movie data set.
-  if (db.movie_lookup_errors)
-    std::cerr << "! " << db.movie_lookup_errors << " movie lookup errors\n";
+    std::FILE* out = output ? std::fopen(output, "w") : stdout;
+    if (!out) {
+      std::cerr << "error: cannot open '" << output << "'\n";
+      return 1;
+    }
+    batch_stats s = run_batch(db, target, names, out, threads);
+    if (out != stdout)
+      std::fclose(out);
+    log << "* " << s.queries << " queries (" << s.found << " found, "
+        << s.connected << " connected) in " << s.seconds << " s, "
+        << s.queries / s.seconds << " queries/s\n";
+#ifdef IMDB_METRICS
+    metrics::report(log);
+#endif
+    return 0;
+  }
 
-    // Get the target actor (Kevin Bacon).
-  const char* kb = "Bacon, Kevin (I)";
-  int target = db.find_actor(kb);
-  std::cout << "* index of \"" << kb << "\": " << target << '\n';
+  if (prefix) {
+    export_stats s = export_graph(db, prefix, format, costars, threads);
+    if (!s.error.empty()) {
+      std::cerr << "error: " << s.error << '\n';
+      return 1;
+    }
+    log << "* exported " << s.roles << " roles";
+    if (costars)
+      log << " and " << s.costars << " co-star edges";
+    log << " (" << (s.bytes >> 20) << " MiB) in " << s.seconds << " s\n";
+    return 0;
+  }
 
-  //set bacon numbers
-  db.BaconNumber();
+  if (socket) {
+    int status = serve(db, db.find_actor(kb), socket, threads);
+#ifdef IMDB_METRICS
+    metrics::report(log);
+#endif
+    return status;
+  }
 
-  // Emulate a simple shell.
+  // Emulate a simple shell. Lines starting with ':' are commands. Optional
+  // numbers before an actor's name are read as numbers unless the rest of
+  // the line names an actor, so ":pagerank 50 Cent" ranks from 50 Cent.
+  //
+  //    :status           show loading progress
+  //    :metrics [reset]  show query latencies and counters, or clear them
+  //    :movie <title>    show a movie's year, kind, and cast size
+  //    :lookup <actor>   show an actor's id and number of roles
+  //    :find <text>      list the actors and movies whose names start with
+  //                      or are a few typos away from the text
+  //    :center <name>    measure distances from another actor
+  //    :cache            show search cache statistics
+  //    :components       show component statistics
+  //    :paths <actor>    count the shortest paths to the center and show
+  //                      the first page of them
+  //    :more             show the next page of paths
+  //    :weights billing|year <year>
+  //                      choose the link weights for weighted paths
+  //    :weighted <actor> show the cheapest weighted path to the center
+  //    :stress <threads> <queries>
+  //                      answer random path queries concurrently against a
+  //                      frozen snapshot of the graph
+  //    :diameter [all]   find the diameter of the center's component and
+  //                      optionally every eccentricity in it
+  //    :landmarks <k> [coverage]
+  //                      build a landmark distance oracle and report its
+  //                      accuracy on a sample of actor pairs
+  //    :landmark <actor>|<actor>[|exact]
+  //                      bound the distance between two actors with the
+  //                      last landmarks built, optionally searching when
+  //                      the bounds differ
+  //    :centrality [sample] [threads]
+  //                      rank actors by betweenness and closeness, using
+  //                      every actor as a source unless a sample is given
+  //    :communities [seed] [actor]
+  //                      find communities by label propagation, and list
+  //                      the best-known members of an actor's community
+  //    :pagerank [tolerance] [actor]
+  //                      rank actors by PageRank, or by personalized
+  //                      PageRank from the given actor
+  //    :reorder degree|bfs|rcm
+  //                      renumber actors and movies for locality
+  //    :common <actor>|<actor>
+  //                      list the movies two actors appeared in together
+  //    :costars <actor>|<actor>
+  //                      count the movies two actors appeared in together
+  //                      without listing them
+  //    :collaborators <actor>
+  //                      show the co-stars an actor shared the most movies
+  //                      with, computing them for every actor on first use
+  //    :compact [actor]  fold episodes into their series and merge repeated
+  //                      roles, report the savings, and optionally show an
+  //                      actor's series-level distance from the center
+  //    :estimate [budget [precision]] [actor]
+  //                      estimate the distances from an actor, or the
+  //                      center, by sampling up to budget targets until
+  //                      the mean is known to within the precision
+  //    :levels [actor]   count the actors at each distance from an actor,
+  //                      or the center, with the parallel search; from
+  //                      the center, check them against the stored ones
+  //    :role <actor>|<movie>|<info>
+  //                      add a role, updating distances incrementally
+  //    :roles <file>     add a batch of tab-separated roles from a file
+  //    :history [actor]  show distances from the center at the end of each
+  //                      decade, for everyone or for one actor
+  //    :filter [first last [kind...]]
+  //                      only follow movies released in the given years,
+  //                      optionally of the given kinds (film, tv, video,
+  //                      game, series, episode); no arguments clears it
+  std::string center = kb;
+  bacon_history history;
+  long history_generation = -1;
+  movie_filter filter;
+  bool filtered = false;
+  path_dag dag;
+  long dag_generation = -1;
+  std::unique_ptr<path_enumerator> pager;
+  int pager_target = -1;
+  weighted_paths weighted;
+  edge_weight weigh_by = billing_weight;
+  long weighted_generation = -1;
+  collaborators collab;
+  long collab_generation = -1;
+  compact_graph compact;
+  long compact_generation = -1;
+  communities circles;
+  long circles_generation = -1;
+  unsigned circles_seed = 0;
+  std::unique_ptr<frozen_graph> frozen;
+  long frozen_generation = -1;
+  landmark_oracle landmarks;
+  landmark_oracle::strategy landmarks_by = landmark_oracle::by_degree;
+  long landmarks_generation = -1;
   while (true) {
     std::string actor;
     std::cout << "actor> ";
     std::getline(std::cin, actor);
     if (!std::cin || actor == "exit")
       break;
+
+    // These work as soon as their tables are loaded.
+    if (actor == ":status") {
+      std::cout << "* " << load.status() << '\n';
+      if (load.failed())
+        std::cout << "! " << load.error << '\n';
+      continue;
+    }
+    if (actor == ":metrics" || actor == ":metrics reset") {
+#ifdef IMDB_METRICS
+      if (actor == ":metrics")
+        metrics::report(std::cout);
+      else
+        metrics::reset();
+#else
+      std::cout << "! built without IMDB_METRICS\n";
+#endif
+      continue;
+    }
+    if (actor.compare(0, 7, ":movie ") == 0) {
+      if (!load.ready(movies_ready)) {
+        std::cout << "* loading: " << load.status() << '\n';
+        continue;
+      }
+      int m = db.find_movie(actor.c_str() + 7);
+      if (m == -1) {
+        std::cout << "! no movie named '" << actor.substr(7) << "'\n";
+        continue;
+      }
+      std::cout << db.movies[m].name << ": year " << db.movies[m].year
+                << ", kind " << int(db.movies[m].kind);
+      if (load.ready(actors_ready))
+        std::cout << ", cast of " << db.movies[m].roles.size();
+      std::cout << '\n';
+      continue;
+    }
+    if (actor.compare(0, 8, ":lookup ") == 0) {
+      if (!load.ready(actors_ready)) {
+        std::cout << "* loading: " << load.status() << '\n';
+        continue;
+      }
+      int a = db.find_actor(actor.substr(8));
+      if (a == -1) {
+        std::cout << "! no actor named '" << actor.substr(8) << "'\n";
+        suggest(db, actor.substr(8), std::cout);
+      } else
+        std::cout << db.actors[a].name << ": id " << a << ", "
+                  << db.actors[a].roles.size() << " roles\n";
+      continue;
+    }
+
+    if (actor.compare(0, 6, ":find ") == 0) {
+      if (!load.ready(actors_ready)) {
+        std::cout << "* loading: " << load.status() << '\n';
+        continue;
+      }
+      std::string text = actor.substr(6);
+      auto start = std::chrono::steady_clock::now();
+      std::vector<name_match> actors = db.actor_names.find(text, 10);
+      std::vector<name_match> movies = db.movie_names.find(text, 5);
+      std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+      for (const name_match& m : actors) {
+        std::cout << "  " << db.actors[m.id].name << " (" << m.weight
+                  << " roles";
+        if (m.edits)
+          std::cout << ", " << m.edits << " edits";
+        std::cout << ")\n";
+      }
+      for (const name_match& m : movies) {
+        std::cout << "  " << db.movies[m.id].name << " (cast of " << m.weight;
+        if (m.edits)
+          std::cout << ", " << m.edits << " edits";
+        std::cout << ")\n";
+      }
+      std::cout << "* " << actors.size() + movies.size() << " matches in "
+                << dt.count() * 1e3 << " ms\n";
+      continue;
+    }
+
+    // Everything else needs the distances.
+    if (!load.ready(distances_ready)) {
+      std::cout << "* loading: " << load.status() << '\n';
+      continue;
+    }
+
+    if (actor.compare(0, 8, ":center ") == 0) {
+      std::string name = actor.substr(8);
+      if (db.find_actor(name) == -1)
+        std::cout << "! no actor named '" << name << "'\n";
+      else
+        center = name;
+      continue;
+    }
+    if (actor == ":components") {
+      db.parts.report(std::cout);
+      continue;
+    }
+    if (actor.compare(0, 9, ":diameter") == 0) {
+      bool all = actor.find("all") != std::string::npos;
+      eccentricity e;
+      e.run(db, db.find_actor(center), all);
+      e.report(std::cout, db);
+      if (all)
+        std::cout << "* radius " << e.radius << '\n';
+      continue;
+    }
+    if (actor.compare(0, 7, ":paths ") == 0 || actor == ":more") {
+      if (actor != ":more") {
+        int c = db.find_actor(center);
+        int a = db.find_actor(actor.substr(7));
+        if (a == -1) {
+          std::cout << "! no actor named '" << actor.substr(7) << "'\n";
+          continue;
+        }
+        if (dag.center != c || dag_generation != db.generation) {
+          if (!db.films.ready())
+            db.films.build(db);
+          dag.build(db, c);
+          dag_generation = db.generation;
+        }
+        std::cout << "* " << dag.paths(a) << " shortest paths\n";
+        pager.reset(new path_enumerator(dag, a));
+        pager_target = a;
+      }
+      if (dag_generation != db.generation)
+        pager.reset();
+      if (!pager)
+        continue;
+      for (const std::vector<path_step>& p : pager->page(10)) {
+        std::cout << "  " << db.actors[pager_target].name;
+        for (const path_step& s : p)
+          std::cout << " / " << db.movies[s.movie].name << " / "
+                    << db.actors[s.actor].name;
+        std::cout << '\n';
+      }
+      continue;
+    }
+    if (actor.compare(0, 9, ":weights ") == 0) {
+      std::istringstream in(actor.substr(9));
+      std::string kind;
+      int year = 0;
+      in >> kind;
+      if (kind == "billing") {
+        weigh_by = billing_weight;
+      } else if (kind == "year" && in >> year) {
+        weigh_by = year_weight(year);
+      } else {
+        std::cout << "! unknown weights '" << actor.substr(9) << "'\n";
+        continue;
+      }
+      weighted.weigh(db, weigh_by);
+      weighted_generation = db.generation;
+      continue;
+    }
+    if (actor.compare(0, 10, ":weighted ") == 0) {
+      int a = db.find_actor(actor.substr(10));
+      if (a == -1) {
+        std::cout << "! no actor named '" << actor.substr(10) << "'\n";
+        continue;
+      }
+      // Reapply the chosen weights to roles added since.
+      if (weighted_generation != db.generation) {
+        weighted.weigh(db, weigh_by);
+        weighted_generation = db.generation;
+      }
+      int c = db.find_actor(center);
+      if (weighted.center != c) {
+        auto start = std::chrono::steady_clock::now();
+        if (!weighted.run(db, c)) {
+          std::cout << "! weights do not cover every role\n";
+          continue;
+        }
+        std::chrono::duration<double> dt =
+          std::chrono::steady_clock::now() - start;
+        std::cout << "* weighted search in " << dt.count() * 1e3 << " ms\n";
+      }
+      if (weighted.cost_of(a) == weighted_paths::unreachable) {
+        std::cout << actor.substr(10) << " has no connection to " << center
+                  << '\n';
+        continue;
+      }
+      std::vector<int> p = weighted.path(db, a);
+      std::cout << db.actors[a].name;
+      for (std::size_t i = 0; i < p.size(); i += 2)
+        std::cout << " / " << db.movies[db.roles[p[i]].movie].name
+                  << " / " << db.actors[db.roles[p[i + 1]].actor].name;
+      std::cout << "\n* cost " << weighted.cost_of(a) << ", "
+                << p.size() / 2 << " links\n";
+      continue;
+    }
+    if (actor.compare(0, 8, ":stress ") == 0) {
+      int threads = 1, queries = 1000;
+      std::sscanf(actor.c_str() + 8, "%d %d", &threads, &queries);
+      threads = std::max(1, threads);
+      frozen_graph g(db);
+      std::atomic<long> total(0), connected(0);
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> pool;
+      for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+          query_context q(g);
+          std::mt19937 gen(t);
+          std::uniform_int_distribution<int> pick(0, g.actors() - 1);
+          std::vector<path_step> steps;
+          long sum = 0, found = 0;
+          for (int i = t; i < queries; i += threads) {
+            int d = q.path(pick(gen), pick(gen), steps);
+            if (d != -1) {
+              sum += d;
+              ++found;
+            }
+          }
+          total += sum;
+          connected += found;
+        });
+      }
+      for (std::thread& t : pool)
+        t.join();
+      std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+      std::cout << "* " << queries << " path queries on " << threads
+                << " threads in " << dt.count() << " s, "
+                << queries / dt.count() << " queries/s, mean length "
+                << double(total) / std::max(1L, long(connected)) << " ("
+                << queries - connected << " disconnected)\n";
+      continue;
+    }
+    if (actor == ":cache") {
+      const bfs_cache& c = db.cache;
+      std::cout << "* cache: " << c.size() << " centers, "
+                << (c.used >> 20) << '/' << (c.capacity >> 20) << " MiB, "
+                << c.hits << " hits, " << c.misses << " misses, "
+                << c.evictions << " evictions\n";
+      continue;
+    }
+
+    if (actor.compare(0, 11, ":landmarks ") == 0) {
+      int k = std::atoi(actor.c_str() + 11);
+      bool coverage = actor.find("coverage") != std::string::npos;
+      landmarks_by = coverage ? landmark_oracle::by_coverage
+                              : landmark_oracle::by_degree;
+      landmarks.build(db, k, landmarks_by);
+      landmarks_generation = db.generation;
+      evaluate(db, landmarks, 1000, std::cout);
+      continue;
+    }
+
+    if (actor.compare(0, 10, ":landmark ") == 0) {
+      std::string first, second, mode;
+      std::istringstream in(actor.substr(10));
+      std::getline(in, first, '|');
+      std::getline(in, second, '|');
+      std::getline(in, mode);
+      if (!mode.empty() && mode != "exact") {
+        std::cout << "! expected 'exact', not '" << mode << "'\n";
+        continue;
+      }
+      int a = db.find_actor(first), b = db.find_actor(second);
+      if (a == -1 || b == -1) {
+        std::string name = a == -1 ? first : second;
+        std::cout << "! no actor named '" << name << "'\n";
+        suggest(db, name, std::cout);
+        continue;
+      }
+      if (!landmarks.size()) {
+        std::cout << "! no landmarks; build them with :landmarks <k>\n";
+        continue;
+      }
+      // Rebuild the same kind of landmarks after the graph changes.
+      if (landmarks_generation != db.generation) {
+        landmarks.build(db, landmarks.size(), landmarks_by);
+        landmarks_generation = db.generation;
+      }
+      int lo = landmarks.lower(a, b), hi = landmarks.upper(a, b);
+      bool exact = !mode.empty();
+      if (lo != -1) {
+        std::cout << "* bounds " << lo << " to ";
+        if (hi == -1)
+          std::cout << "unknown\n";
+        else
+          std::cout << hi << '\n';
+      }
+      if (lo != -1 && hi == -1 && !exact) {
+        std::cout << "! no landmark reaches both actors; add |exact to search\n";
+        continue;
+      }
+      int d = landmarks.distance(db, a, b, exact);
+      if (d == -1)
+        std::cout << first << " has no connection to " << second << '\n';
+      else if (lo == hi || exact)
+        std::cout << first << " is " << d << " from " << second << '\n';
+      else
+        std::cout << first << " is at most " << d << " from " << second
+                  << '\n';
+      continue;
+    }
+
+    if (actor.compare(0, 11, ":centrality") == 0) {
+      int sample = 0, threads = 0;
+      std::sscanf(actor.c_str() + 11, "%d %d", &sample, &threads);
+      centrality c;
+      c.progress = &std::cerr;
+      c.run(db, sample, threads);
+      std::cout << "* " << c.sources << " sources in " << c.seconds << " s\n";
+      std::cout << "* betweenness:\n";
+      for (int a : c.top(c.betweenness, 10))
+        std::cout << "  " << c.betweenness[a] << '\t' << db.actors[a].name << '\n';
+      std::cout << "* closeness:\n";
+      for (int a : c.top(c.closeness, 10))
+        std::cout << "  " << c.closeness[a] << '\t' << db.actors[a].name << '\n';
+      continue;
+    }
+
+    if (actor == ":communities" || actor.compare(0, 13, ":communities ") == 0) {
+      std::string rest = actor.size() > 13 ? actor.substr(13) : "";
+      double number = 1;
+      if (take_number(db, rest, number) &&
+          (number < 0 || number > UINT_MAX || number != std::floor(number))) {
+        std::cout << "! the seed must be a whole number from 0 to "
+                  << UINT_MAX << '\n';
+        continue;
+      }
+      unsigned seed = number;
+      int a = rest.empty() ? -1 : db.find_actor(rest);
+      if (!rest.empty() && a == -1) {
+        std::cout << "! no actor named '" << rest << "'\n";
+        suggest(db, rest, std::cout);
+        continue;
+      }
+      if (!circles.label.size() || circles_generation != db.generation ||
+          circles_seed != seed) {
+        circles.run(db, seed);
+        circles_generation = db.generation;
+        circles_seed = seed;
+        circles.report(std::cout);
+      }
+      if (a != -1) {
+        // The members with the most roles.
+        std::vector<int> members;
+        for (int b = 0; b < db.actors.size(); ++b)
+          if (circles.label[b] == circles.label[a])
+            members.push_back(b);
+        int k = std::min<int>(10, members.size());
+        std::partial_sort(members.begin(), members.begin() + k, members.end(),
+                          [&](int x, int y) {
+          return db.actors[x].roles.size() > db.actors[y].roles.size();
+        });
+        std::cout << "* " << members.size() << " actors in the community of "
+                  << db.actors[a].name << '\n';
+        for (int i = 0; i < k; ++i)
+          std::cout << "  " << db.actors[members[i]].roles.size() << '\t'
+                    << db.actors[members[i]].name << '\n';
+      }
+      continue;
+    }
+
+    if (actor == ":pagerank" || actor.compare(0, 10, ":pagerank ") == 0) {
+      std::string rest = actor.size() > 10 ? actor.substr(10) : "";
+      double tolerance = 1e-6;
+      take_number(db, rest, tolerance);
+      int source = rest.empty() ? -1 : db.find_actor(rest);
+      if (!rest.empty() && source == -1) {
+        std::cout << "! no actor named '" << rest << "'\n";
+        suggest(db, rest, std::cout);
+        continue;
+      }
+      pagerank pr;
+      pr.run(db, source, tolerance);
+      std::cout << "* " << pr.iterations << " iterations in " << pr.seconds
+                << " s, last change " << pr.residual << '\n';
+      // Scaled so that 1 is the rank of an average vertex.
+      double scale = db.actors.size() + db.movies.size();
+      for (int a : pr.top(10))
+        std::cout << "  " << pr.actor_rank[a] * scale << '\t'
+                  << db.actors[a].name << '\n';
+      continue;
+    }
+
+    if (actor.compare(0, 9, ":reorder ") == 0) {
+      vertex_order k;
+      if (!parse_order(actor.substr(9), k)) {
+        std::cout << "! unknown order '" << actor.substr(9) << "'\n";
+        continue;
+      }
+      report(reorder(db, k), std::cout);
+      continue;
+    }
+
+    bool costars = actor.compare(0, 9, ":costars ") == 0;
+    if (actor.compare(0, 8, ":common ") == 0 || costars) {
+      std::string first, second;
+      std::istringstream in(actor.substr(costars ? 9 : 8));
+      std::getline(in, first, '|');
+      std::getline(in, second);
+      int a = db.find_actor(first), b = db.find_actor(second);
+      if (a == -1 || b == -1) {
+        std::string name = a == -1 ? first : second;
+        std::cout << "! no actor named '" << name << "'\n";
+        suggest(db, name, std::cout);
+        continue;
+      }
+      auto start = std::chrono::steady_clock::now();
+      if (costars) {
+        int count = db.costar_count(a, b);
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+        std::cout << "* " << count << " movies in common in "
+                  << dt.count() * 1e3 << " ms\n";
+        continue;
+      }
+      std::vector<int> common = db.common_movies(a, b);
+      std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+      for (int m : common)
+        std::cout << "  " << db.movies[m].name << '\n';
+      std::cout << "* " << common.size() << " movies in common ("
+                << db.films.size(a) << " and " << db.films.size(b)
+                << " movies) in " << dt.count() * 1e3 << " ms\n";
+      continue;
+    }
+
+    if (actor.compare(0, 15, ":collaborators ") == 0) {
+      int a = db.find_actor(actor.substr(15));
+      if (a == -1) {
+        std::cout << "! no actor named '" << actor.substr(15) << "'\n";
+        suggest(db, actor.substr(15), std::cout);
+        continue;
+      }
+      if (!collab.ready() || collab_generation != db.generation) {
+        collab.run(db, 10);
+        collab_generation = db.generation;
+        std::cout << "* counted " << collab.pairs << " co-star pairs in "
+                  << collab.seconds << " s\n";
+      }
+      const collaborator* c = collab.begin(a);
+      for (int i = 0; i < collab.size(a); ++i)
+        std::cout << "  " << c[i].shared << '\t' << db.actors[c[i].actor].name
+                  << '\n';
+      continue;
+    }
+
+    if (actor == ":compact" || actor.compare(0, 9, ":compact ") == 0) {
+      int a = actor.size() > 9 ? db.find_actor(actor.substr(9)) : -1;
+      if (actor.size() > 9 && a == -1) {
+        std::cout << "! no actor named '" << actor.substr(9) << "'\n";
+        suggest(db, actor.substr(9), std::cout);
+        continue;
+      }
+      if (!compact.ready() || compact_generation != db.generation) {
+        compact.build(db);
+        compact_generation = db.generation;
+        compact.report(std::cout);
+      }
+      if (a != -1) {
+        int c = db.find_actor(center);
+        std::vector<int> dist;
+        compact.search(c, dist);
+        if (dist[a] == -1) {
+          std::cout << actor.substr(9) << " has no connection to " << center
+                    << '\n';
+          continue;
+        }
+        std::cout << actor.substr(9) << " is " << dist[a] << " from " << center
+                  << " by series (" << db.distance_between(a, c)
+                  << " by episode)\n";
+      }
+      continue;
+    }
+
+    if (actor == ":estimate" || actor.compare(0, 10, ":estimate ") == 0) {
+      std::string rest = actor.size() > 10 ? actor.substr(10) : "";
+      double budget = 10000, precision = 0.01;
+      if (take_number(db, rest, budget)) {
+        if (budget < 1 || budget > INT_MAX || budget != std::floor(budget)) {
+          std::cout << "! the budget must be a whole number from 1 to "
+                    << INT_MAX << '\n';
+          continue;
+        }
+        if (take_number(db, rest, precision) && !(precision >= 0)) {
+          std::cout << "! the precision must not be negative\n";
+          continue;
+        }
+      }
+      std::string name = rest.empty() ? center : rest;
+      int c = db.find_actor(name);
+      if (c == -1) {
+        std::cout << "! no actor named '" << name << "'\n";
+        suggest(db, name, std::cout);
+        continue;
+      }
+      distance_estimate e;
+      e.run(db, c, budget, precision);
+      e.report(std::cout);
+      continue;
+    }
+
+    if (actor == ":levels" || actor.compare(0, 8, ":levels ") == 0) {
+      std::string name = actor.size() > 8 ? actor.substr(8) : center;
+      int c = db.find_actor(name);
+      if (c == -1) {
+        std::cout << "! no actor named '" << name << "'\n";
+        suggest(db, name, std::cout);
+        continue;
+      }
+      if (!frozen || frozen_generation != db.generation) {
+        frozen.reset(new frozen_graph(db));
+        frozen_generation = db.generation;
+      }
+      levels bfs;
+      bfs.run(vertex_graph(*frozen), c);
+      bfs.report(std::cout);
+
+      // The center's distances are also kept by the sequential search.
+      if (c == db.center) {
+        int wrong = bfs.check(db.distance);
+        if (wrong)
+          std::cout << "! " << wrong << " distances differ from the center's\n";
+        else
+          std::cout << "* distances match the center's\n";
+      }
+      continue;
+    }
+
+    if (actor.compare(0, 6, ":role ") == 0 ||
+        actor.compare(0, 7, ":roles ") == 0) {
+      std::vector<role_update> rows;
+      if (actor[5] == ' ') {
+        role_update r;
+        std::istringstream in(actor.substr(6));
+        std::getline(in, r.actor, '|');
+        std::getline(in, r.movie, '|');
+        std::getline(in, r.info);
+        rows.push_back(r);
+      } else {
+        std::ifstream in(actor.substr(7));
+        std::string line;
+        while (std::getline(in, line)) {
+          role_update r;
+          std::istringstream fields(line);
+          std::getline(fields, r.actor, '\t');
+          std::getline(fields, r.movie, '\t');
+          std::getline(fields, r.info);
+          rows.push_back(r);
+        }
+      }
+      long before = db.dynamic_updates;
+      auto start = std::chrono::steady_clock::now();
+      int n = db.add_roles(rows);
+      std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+      std::cout << "* added " << n << '/' << rows.size() << " roles, "
+                << db.dynamic_updates - before << " distances lowered in "
+                << dt.count() * 1e3 << " ms\n";
+      continue;
+    }
+
+    if (actor.compare(0, 8, ":history") == 0) {
+      int c = db.find_actor(center);
+      if (history.center != c || history_generation != db.generation) {
+        std::vector<int> years;
+        int first = 0, last = 0;
+        for (int m = 0; m < db.movies.size(); ++m) {
+          int y = db.movies[m].year;
+          if (y && (!first || y < first))
+            first = y;
+          last = std::max(last, y);
+        }
+        for (int y = first / 10 * 10 + 9; y < last; y += 10)
+          years.push_back(y);
+        years.push_back(last);
+        history.run(db, c, years);
+        history_generation = db.generation;
+        std::cout << "* swept " << years.size() << " years in "
+                  << history.seconds << " s\n";
+      }
+      int a = actor.size() > 9 ? db.find_actor(actor.substr(9)) : -1;
+      for (std::size_t i = 0; i < history.years.size(); ++i) {
+        std::cout << "  " << history.years[i] << ": ";
+        if (a != -1) {
+          std::cout << history.at(a, i) << '\n';
+          continue;
+        }
+        long reached = 0, total = 0;
+        for (int b = 0; b < db.actors.size(); ++b) {
+          if (history.at(b, i) >= 0) {
+            ++reached;
+            total += history.at(b, i);
+          }
+        }
+        std::cout << reached << " reachable, mean "
+                  << (reached ? double(total) / reached : 0) << '\n';
+      }
+      continue;
+    }
+
+    if (actor.compare(0, 7, ":filter") == 0) {
+      std::istringstream in(actor.substr(7));
+      movie_filter f;
+      std::string kind;
+      if (!(in >> f.first >> f.last)) {
+        filtered = false;
+        continue;
+      }
+      unsigned kinds = 0, k = 0;
+      while (in >> kind && (k = kind_named(kind)))
+        kinds |= k;
+      if (in && !k) {
+        std::cout << "! unknown kind '" << kind << "'\n";
+        continue;
+      }
+      if (kinds)
+        f.kinds = kinds;
+      filter = f;
+      filtered = true;
+      std::cout << "* " << movie_mask(db.movies, f).count()
+                << " movies pass the filter\n";
+      continue;
+    }
+
+    // Reject unknown and unreachable actors up front.
+    int a = db.find_actor(actor), c = db.find_actor(center);
+    if (a == -1) {
+      std::cout << "! no actor named '" << actor << "'\n";
+      suggest(db, actor, std::cout);
+      continue;
+    }
+    if (!db.parts.connected(a, c)) {
+      std::cout << actor << " has no connection to " << center
+                << " (component of " << db.parts.size_of(a) << ")\n";
+      continue;
+    }
+
     // int source = db.find_actor(actor);
-    int source = db.Display(actor);
-    std::cout << actor << " has the Bacon Number "  << source << '\n';
+    int source = filtered ? db.Display(actor, center, filter)
+                          : db.Display(actor, center);
+    if (source == -1) {
+      // Connected, but only through movies the filter drops.
+      std::cout << actor << " has no connection to " << center
+                << " through the filtered movies\n";
+      continue;
+    }
+    if (center == kb)
+      std::cout << actor << " has the Bacon Number "  << source << '\n';
+    else
+      std::cout << actor << " is " << source << " from " << center << '\n';
   }
 
+#ifdef IMDB_METRICS
+  metrics::report(std::cout);
+#endif
 }
@@ -7,8 +7,16 @@
 #include "movies.hpp"
 #include "actors.hpp"
 #include "roles.hpp"
+#include "cache.hpp"
+#include "filter.hpp"
+#include "components.hpp"
+#include "films.hpp"
+#include "names.hpp"
 #include <queue>
 
+// The actor used as the center when none is given.
+constexpr const char* default_center = "Bacon, Kevin (I)";
+
 struct Vertex
 {
   //identifier
@@ -34,11 +42,52 @@ struct Vertex
 
 };
 
+// A role that arrives after the database has been loaded.
+struct role_update
+{
+  std::string actor;
+  std::string movie;
+  std::string info;
+};
+
+// Marks for bidirectional searches. Each search stamps what it touches
+// with a new epoch, so a scratch reused across searches never has to be
+// cleared, and a search costs only the part of the graph it reaches.
+struct meet_scratch
+{
+  // Begins a new search over a graph of the given size.
+  void start(int actors, int movies);
+
+  // Returns the distance of a from the given side, or -1.
+  int distance(int side, int a) const {
+    return mark[side][a] == epoch ? dist[side][a] : -1;
+  }
+
+  void reach(int side, int a, int d) {
+    mark[side][a] = epoch;
+    dist[side][a] = d;
+  }
+
+  // Marks movie m as expanded by the given side; false if it already was.
+  bool visit(int side, int m) {
+    if (film[side][m] == epoch)
+      return false;
+    film[side][m] = epoch;
+    return true;
+  }
+
+  unsigned epoch = 0;
+  std::vector<unsigned> mark[2];
+  std::vector<int> dist[2];
+  std::vector<unsigned> film[2];
+};
+
 struct database
 {
   database();
 
-  std::vector<int> distance; //kevin bacon # storage
+  int center = -1; //actor at the center of distance and path
+  std::vector<int> distance; //kevin bacon #, or -1 if unreachable
   std::vector<Vertex> path; //path to kevin bacon.
 
   int add_movie(const char* name, const char* year);
@@ -49,13 +98,43 @@ struct database
 
   int find_actor(const std::string& name);
   int add_role(const char* act, const char* mov, const char* info);
+  int add_roles(const std::vector<role_update>& rows);
 
   //compute bacon number
   void BaconNumber();
+  //compute distances from an arbitrary center actor
+  void BaconNumber(int center);
   //Perform a breath first search to find actor
   void BFS(Vertex v);
+
+  //Incremental maintenance of distance and path as roles are added
+  bool reached(int a) const;
+  void improve(int w, int u, int film, int d, std::vector<std::vector<int>>& q);
+  void relax(int a, int film, std::vector<std::vector<int>>& q);
+  void propagate(std::vector<std::vector<int>>& q);
+  //Returns the (cached) compact search result for the given center
+  bfs_ptr search(int center);
+  //Computes a compact search result without consulting the cache
+  std::shared_ptr<bfs_result> explore(int center);
+  std::shared_ptr<bfs_result> explore(int center, const movie_mask& mask);
+  //Returns the exact distance between two actors, or -1 if there is none
+  int distance_between(int a, int b);
+  //Same, reusing scratch space across calls
+  int distance_between(int a, int b, meet_scratch& scratch);
+  int distance_between(int a, int b, const movie_mask& mask);
+  //Returns the movies both actors appear in, in id order
+  std::vector<int> common_movies(int a, int b);
+  //Returns the number of movies both actors appear in
+  int costar_count(int a, int b);
   //Displays the movies and actors linking the given actor and kevin bacon
   int Display(const std::string& actor);
+  //Displays the path linking the given actor to an arbitrary center
+  int Display(const std::string& actor, const std::string& center);
+  //Displays the path using only the movies accepted by the filter
+  int Display(const std::string& actor, const std::string& center,
+              const movie_filter& filter);
+  //Displays the path to target recorded in a compact search result
+  int Display(int target, const bfs_result& r);
 
   // Storage for movies and actors.
   movie_table movies;
@@ -66,6 +145,28 @@ struct database
   name_index movie_lookup;
   name_index actor_lookup;
 
+  // Prefix and typo-tolerant search over names, built after loading.
+  // Actors added later are not indexed.
+  name_search actor_names;
+  name_search movie_names;
+
+  // Connected components, computed after loading.
+  components parts;
+
+  // Sorted movie lists for shared-filmography queries.
+  filmographies films;
+
+  // Recently computed searches from other centers.
+  bfs_cache cache;
+
+  // When set, distance and path are kept up to date as roles are added.
+  bool dynamic = false;
+  long dynamic_updates = 0; // Number of distance improvements applied
+
+  // Changes whenever actors or roles are added or ids are renumbered, so
+  // results computed from the graph can tell when they are out of date.
+  long generation = 0;
+
   int movie_lookup_errors = 0;
 };
 
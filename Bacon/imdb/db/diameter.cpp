@@ -0,0 +1,105 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "diameter.hpp"
+#include "db.hpp"
+#include "levels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <ostream>
+
+void
+eccentricity::run(database& db, int c, bool all) {
+  auto start = std::chrono::steady_clock::now();
+
+  members.clear();
+  for (int a = 0; a < db.actors.size(); ++a)
+    if (db.parts.connected(a, c))
+      members.push_back(a);
+  int n = members.size();
+  lower.assign(n, 0);
+  upper.assign(n, INT_MAX);
+
+  // Candidates are kept as positions into members.
+  std::vector<int> candidates(n);
+  for (int i = 0; i < n; ++i)
+    candidates[i] = i;
+
+  auto degree = [&](int i) { return db.actors[members[i]].roles.size(); };
+
+  frozen_graph g(db);
+  vertex_graph vg(g);
+  levels r;
+
+  diameter = 0;
+  radius = INT_MAX;
+  searches = 0;
+  int bound = INT_MAX; // Upper bound on the diameter
+  bool high = true;
+  while (!candidates.empty() && (all || diameter < bound)) {
+    // Choose the next source, breaking ties by degree.
+    int v = candidates[0];
+    for (int i : candidates) {
+      if (high ? (upper[i] > upper[v] ||
+                   (upper[i] == upper[v] && degree(i) > degree(v)))
+               : (lower[i] < lower[v] ||
+                   (lower[i] == lower[v] && degree(i) > degree(v))))
+        v = i;
+    }
+    high = !high;
+
+    r.run(vg, members[v]);
+    ++searches;
+    int e = 0, far = members[v];
+    for (int a : members) {
+      if (r.distance[a] > e) {
+        e = r.distance[a];
+        far = a;
+      }
+    }
+    if (e > diameter) {
+      diameter = e;
+      from = members[v];
+      to = far;
+    }
+    radius = std::min(radius, e);
+
+    // Tighten the bounds of every candidate and drop the settled ones.
+    bound = 0;
+    for (int i = 0; i < n; ++i) {
+      int d = r.distance[members[i]];
+      lower[i] = std::max(lower[i], std::max(d, e - d));
+      upper[i] = std::min(upper[i], e + d);
+      bound = std::max(bound, upper[i]);
+    }
+    auto settled = [&](int i) {
+      if (lower[i] == upper[i])
+        return true;
+      if (all)
+        return false;
+      return upper[i] <= diameter && 2 * lower[i] >= bound;
+    };
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    settled),
+                     candidates.end());
+  }
+
+  if (all)
+    for (int i = 0; i < n; ++i)
+      radius = std::min(radius, upper[i]);
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
+
+void
+eccentricity::report(std::ostream& os, const database& db) const {
+  os << "* diameter " << diameter << " after " << searches
+     << " searches in " << seconds << " s over " << members.size()
+     << " actors\n";
+  if (from != -1)
+    os << "  " << db.actors[from].name << " -- " << db.actors[to].name
+       << '\n';
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_DIAMETER_HPP
+#define IMDB_DIAMETER_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// Exact diameter and eccentricities of one component of the actor graph.
+//
+// This follows Takes and Kosters' bounding algorithm. Each actor keeps a
+// lower and an upper bound on its eccentricity. A search from v gives the
+// exact eccentricity e of v and, for every w at distance d from it,
+//
+//    max(d, e - d) <= ecc(w) <= e + d
+//
+// Actors that can neither raise the lower bound on the diameter nor lower
+// its upper bound are dropped from the candidates. The next search starts
+// alternately from the candidate with the largest upper bound and the one
+// with the smallest lower bound. On real-world graphs this settles the
+// diameter after a few dozen searches, each of which is the parallel
+// breadth-first search of levels.hpp.
+struct eccentricity
+{
+  // Computes the diameter of the component containing actor c. If all
+  // is set, searching continues until every eccentricity is exact.
+  void run(database& db, int c, bool all = false);
+
+  void report(std::ostream& os, const database& db) const;
+
+  int diameter = 0;
+  int radius = 0;    // Only exact when all eccentricities are
+  int from = -1;     // An actor pair at distance diameter
+  int to = -1;
+  int searches = 0;
+  double seconds = 0;
+
+  std::vector<int> members; // Actors in the component
+  std::vector<int> lower;   // Eccentricity bounds, parallel to members
+  std::vector<int> upper;
+};
+
+
+#endif
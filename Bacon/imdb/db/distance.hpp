@@ -0,0 +1,23 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_DISTANCE_HPP
+#define IMDB_DISTANCE_HPP
+
+
+// Distances stored in one byte per actor or movie.
+//
+// The largest value marks what a search cannot reach. No real path is that
+// long, but a longer one must not wrap around into the marker or back to
+// small values, so distances saturate one below it.
+constexpr unsigned char unreachable = 0xff;
+constexpr unsigned char max_distance = unreachable - 1;
+
+// Returns d as a byte distance, saturating at max_distance.
+inline unsigned char
+byte_distance(int d) {
+  return d < max_distance ? d : max_distance;
+}
+
+
+#endif
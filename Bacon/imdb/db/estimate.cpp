@@ -0,0 +1,168 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "estimate.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// Precision is only tested once this many targets have been reached, and
+// then every few samples.
+constexpr long min_samples = 100;
+constexpr long check_every = 50;
+
+// A full search from the center costs about as much as this many
+// bidirectional searches between random actors.
+constexpr int meets_per_search = 64;
+
+// Returns z such that a standard normal variable falls within z of the
+// mean with probability c.
+double
+z_score(double c) {
+  double lo = 0, hi = 10;
+  for (int i = 0; i < 60; ++i) {
+    double z = (lo + hi) / 2;
+    if (std::erf(z / std::sqrt(2.0)) < c)
+      lo = z;
+    else
+      hi = z;
+  }
+  return (lo + hi) / 2;
+}
+
+// Returns the r-th smallest distance in the histogram, counting from 0.
+int
+nth(const std::vector<long>& histogram, long r) {
+  for (std::size_t d = 0; d < histogram.size(); ++d) {
+    if (r < histogram[d])
+      return d;
+    r -= histogram[d];
+  }
+  return histogram.size() - 1;
+}
+
+} // namespace
+
+void
+distance_estimate::run(database& db, int c, int budget, double p,
+                       double conf, unsigned seed) {
+  auto start = std::chrono::steady_clock::now();
+  *this = distance_estimate();
+  center = c;
+  precision = p;
+  confidence = std::min(std::max(conf, 0.5), 0.999999);
+  double z = z_score(confidence);
+  int n = db.actors.size();
+  if (n < 2)
+    return;
+
+  // Find or pay for an exact search only when the sample would cost more.
+  bool current = db.center == c && int(db.distance.size()) == n;
+  bfs_ptr r;
+  if (!current) {
+    r = db.cache.find(c);
+    if (!r && long(budget) * meets_per_search >= n) {
+      std::shared_ptr<bfs_result> s = db.explore(c);
+      db.cache.insert(s);
+      r = s;
+    }
+  }
+  method = current || r ? exact : meet;
+
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> pick(0, n - 2);
+  meet_scratch scratch;
+  double sum = 0, squares = 0;
+  while (samples < budget) {
+    int t = pick(gen);
+    if (t >= c)
+      ++t;
+    int d;
+    if (current)
+      d = db.distance[t];
+    else if (r)
+      d = r->distance[t] == unreachable ? -1 : r->distance[t];
+    else if (db.parts.ready() && !db.parts.connected(c, t))
+      d = -1;
+    else
+      d = db.distance_between(c, t, scratch);
+
+    ++samples;
+    if (d != -1) {
+      ++reached;
+      if (d >= int(histogram.size()))
+        histogram.resize(d + 1);
+      ++histogram[d];
+      sum += d;
+      squares += double(d) * d;
+    }
+
+    if (precision > 0 && reached >= min_samples &&
+        samples % check_every == 0) {
+      double m = sum / reached;
+      double var = (squares - reached * m * m) / (reached - 1);
+      if (z * std::sqrt(var / reached) <= precision) {
+        converged = true;
+        break;
+      }
+    }
+  }
+
+  if (reached) {
+    mean = sum / reached;
+    if (reached > 1) {
+      double var = (squares - reached * mean * mean) / (reached - 1);
+      mean_error = z * std::sqrt(std::max(0.0, var) / reached);
+    }
+
+    // The ranks of the interval bound the median with the given confidence
+    // whatever the distribution, by the binomial count of samples below it.
+    double half = z * std::sqrt(double(reached)) / 2;
+    long lo = std::max(0L, long(std::floor(reached / 2.0 - half)));
+    long hi = std::min(reached - 1, long(std::ceil(reached / 2.0 + half)));
+    median = nth(histogram, (reached - 1) / 2);
+    median_low = nth(histogram, lo);
+    median_high = nth(histogram, hi);
+  }
+
+  double f = double(reached) / samples;
+  double z2 = z * z / samples;
+  double mid = (f + z2 / 2) / (1 + z2);
+  double width = z * std::sqrt(f * (1 - f) / samples + z2 / (4 * samples))
+               / (1 + z2);
+  reach = f;
+  reach_low = std::max(0.0, mid - width);
+  reach_high = std::min(1.0, mid + width);
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
+
+void
+distance_estimate::report(std::ostream& os) const {
+  os << "* " << samples << " samples (" << reached << " reached) by "
+     << (method == exact ? "exact search" : "bidirectional search") << " in "
+     << seconds * 1e3 << " ms";
+  if (converged)
+    os << "; within " << precision << " of the mean";
+  os << '\n';
+  if (!samples)
+    return;
+  int pct = std::lround(confidence * 100);
+  if (reached)
+    os << "  mean " << mean << " +/- " << mean_error << " (" << pct << "%)\n"
+       << "  median " << median << " [" << median_low << ", " << median_high
+       << "]\n";
+  os << "  reachable " << reach * 100 << "% [" << reach_low * 100 << "%, "
+     << reach_high * 100 << "%]\n";
+  // The center is never sampled, so no target is at distance 0.
+  for (std::size_t d = 1; d < histogram.size(); ++d)
+    os << "  " << d << ": " << histogram[d] << " ("
+       << 100.0 * histogram[d] / reached << "%)\n";
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_ESTIMATE_HPP
+#define IMDB_ESTIMATE_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// Distance statistics for a center, estimated from a random sample of
+// target actors instead of a search of the whole graph.
+//
+// Targets are drawn uniformly, with replacement, from all other actors.
+// Each is answered from an exact search from the center when one is at
+// hand (the current center or a cached result), and otherwise by a
+// bidirectional search, which only reaches a small part of the graph. If
+// the budget is large enough that the bidirectional searches would cost
+// more than a single full search, the full search is run once instead.
+//
+// The mean distance of reachable targets comes with a normal confidence
+// interval, the median with a distribution-free one from the order
+// statistics of the sample, and the fraction of reachable actors with a
+// Wilson interval. Sampling stops early once the mean is known to within
+// the requested precision.
+struct distance_estimate
+{
+  enum method_kind
+  {
+    meet,  // Bidirectional search per target
+    exact, // Lookups in a search from the center
+  };
+
+  // Samples up to budget targets. A precision of 0 uses the whole budget.
+  void run(database& db, int center, int budget, double precision = 0.01,
+           double confidence = 0.95, unsigned seed = 1);
+
+  void report(std::ostream& os) const;
+
+  int center = -1;
+  method_kind method = meet;
+  double confidence = 0;
+  double precision = 0;
+
+  long samples = 0;
+  long reached = 0;
+  std::vector<long> histogram; // Reached targets at each distance
+
+  double mean = 0;
+  double mean_error = 0; // Half width of the interval around the mean
+  int median = -1;
+  int median_low = -1;
+  int median_high = -1;
+  double reach = 0;      // Fraction of targets reachable from the center
+  double reach_low = 0;
+  double reach_high = 0;
+
+  bool converged = false; // Stopped early at the requested precision
+  double seconds = 0;
+};
+
+
+#endif
@@ -0,0 +1,237 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "export.hpp"
+#include "db.hpp"
+#include "graph.hpp"
+#include "writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t buffer_size = 16 << 20;
+
+// Actors per unit of co-star work, and units per thread in each window.
+constexpr int costar_block = 256;
+constexpr int window_blocks = 8;
+
+// File magic, padded to the width of the header field. The terminating
+// NUL of each literal is not copied.
+const char csr_magic[] = "IMDB-CSR";
+const char edge_magic[] = "IMDB-EL\0";
+
+std::FILE*
+open(const std::string& path, export_stats& s) {
+  std::FILE* f = std::fopen(path.c_str(), "wb");
+  if (!f && s.error.empty())
+    s.error = "cannot open '" + path + "'";
+  return f;
+}
+
+// Closes the file, recording its size or the first write error.
+void
+close(std::FILE* f, const std::string& path, export_stats& s) {
+  std::fseek(f, 0, SEEK_END);
+  long n = std::ftell(f);
+  bool bad = std::ferror(f);
+  if (std::fclose(f) != 0 || bad) {
+    if (s.error.empty())
+      s.error = "cannot write '" + path + "'";
+    return;
+  }
+  s.bytes += n;
+}
+
+export_header
+header(const char (&magic)[sizeof csr_magic], int rows, int columns,
+       std::uint64_t edges) {
+  static_assert(sizeof csr_magic == sizeof(export_header::magic) + 1,
+                "magic does not fit the header");
+  export_header h;
+  std::memcpy(h.magic, magic, sizeof h.magic);
+  h.rows = rows;
+  h.columns = columns;
+  h.edges = edges;
+  return h;
+}
+
+template<typename T>
+void
+put(buffered_writer& w, const T* p, std::size_t n) {
+  w.write(reinterpret_cast<const char*>(p), n * sizeof(T));
+}
+
+template<typename T>
+void
+write_names(const table<T>& t, const std::string& path, export_stats& s) {
+  std::FILE* f = open(path, s);
+  if (!f)
+    return;
+  {
+    buffered_writer w(f, buffer_size);
+    for (const T& row : t.rows) {
+      w.write(row.name);
+      w.write("\n", 1);
+    }
+  }
+  close(f, path, s);
+}
+
+// The film lists already hold the distinct movies of each actor in order,
+// so the CSR columns are written as they are.
+void
+write_roles(const database& db, const std::string& path, export_format k,
+            export_stats& s) {
+  std::FILE* f = open(path, s);
+  if (!f)
+    return;
+  const filmographies& films = db.films;
+  int n = db.actors.size();
+  s.roles = films.movies.size();
+  {
+    buffered_writer w(f, buffer_size);
+    if (k == export_format::csr) {
+      export_header h = header(csr_magic, n, db.movies.size(), s.roles);
+      put(w, &h, 1);
+      for (int a = 0; a <= n; ++a) {
+        std::uint64_t x = films.first[a];
+        put(w, &x, 1);
+      }
+      put(w, films.movies.data(), films.movies.size());
+    } else {
+      export_header h = header(edge_magic, n, db.movies.size(), s.roles);
+      put(w, &h, 1);
+      for (int a = 0; a < n; ++a) {
+        const int* m = films.begin(a);
+        for (int i = 0; i < films.size(a); ++i) {
+          std::uint32_t pair[2] = {std::uint32_t(a), std::uint32_t(m[i])};
+          put(w, pair, 2);
+        }
+      }
+    }
+  }
+  close(f, path, s);
+}
+
+// The co-stars of a run of actors: their lists back to back, and the
+// length of each.
+struct costar_block_list
+{
+  std::vector<std::uint32_t> ids;
+  std::vector<std::uint32_t> degree;
+};
+
+// Collects the distinct co-stars of actors [lo, hi). With upper set, only
+// co-stars with larger ids are kept.
+void
+find_costars(const database& db, int lo, int hi, bool upper,
+             costar_block_list& out) {
+  out.ids.clear();
+  out.degree.clear();
+  for (int a = lo; a < hi; ++a) {
+    std::size_t start = out.ids.size();
+    const int* m = db.films.begin(a);
+    for (int i = 0; i < db.films.size(a); ++i) {
+      for (int x : db.movies[m[i]].roles) {
+        int b = db.roles[x].actor;
+        if (upper ? b > a : b != a)
+          out.ids.push_back(b);
+      }
+    }
+    std::sort(out.ids.begin() + start, out.ids.end());
+    out.ids.erase(std::unique(out.ids.begin() + start, out.ids.end()),
+                  out.ids.end());
+    out.degree.push_back(out.ids.size() - start);
+  }
+}
+
+void
+write_costars(const database& db, const std::string& path, export_format k,
+              int threads, export_stats& s) {
+  std::FILE* f = open(path, s);
+  if (!f)
+    return;
+  threads = thread_count(threads);
+  int n = db.actors.size();
+  bool csr = k == export_format::csr;
+  std::vector<std::uint64_t> first;
+  if (csr)
+    first.assign(n + 1, 0);
+
+  // Leave room for the header and offsets, which are known at the end.
+  std::uint64_t count = 0;
+  {
+    buffered_writer w(f, buffer_size);
+    export_header h = header(csr ? csr_magic : edge_magic, n, n, 0);
+    put(w, &h, 1);
+    if (csr)
+      put(w, first.data(), first.size());
+
+    int window = threads * window_blocks * costar_block;
+    std::vector<costar_block_list> blocks(threads * window_blocks);
+    for (int base = 0; base < n; base += window) {
+      int end = std::min(n, base + window);
+      parallel_blocks(end - base, costar_block, threads,
+                      [&](int lo, int hi, int) {
+        find_costars(db, base + lo, base + hi, !csr,
+                     blocks[lo / costar_block]);
+      });
+      for (int i = 0; i * costar_block < end - base; ++i) {
+        const costar_block_list& b = blocks[i];
+        int a = base + i * costar_block;
+        if (csr) {
+          put(w, b.ids.data(), b.ids.size());
+          for (std::uint32_t d : b.degree) {
+            first[a + 1] = first[a] + d;
+            ++a;
+          }
+        } else {
+          const std::uint32_t* p = b.ids.data();
+          for (std::uint32_t d : b.degree) {
+            for (std::uint32_t j = 0; j < d; ++j) {
+              std::uint32_t pair[2] = {std::uint32_t(a), p[j]};
+              put(w, pair, 2);
+            }
+            p += d;
+            ++a;
+          }
+        }
+        count += b.ids.size();
+      }
+    }
+  }
+
+  export_header h = header(csr ? csr_magic : edge_magic, n, n, count);
+  std::fseek(f, 0, SEEK_SET);
+  std::fwrite(&h, sizeof h, 1, f);
+  if (csr)
+    std::fwrite(first.data(), sizeof(std::uint64_t), first.size(), f);
+  s.costars = count;
+  close(f, path, s);
+}
+
+} // namespace
+
+export_stats
+export_graph(database& db, const std::string& prefix, export_format k,
+             bool costars, int threads) {
+  auto start = std::chrono::steady_clock::now();
+  export_stats s;
+  if (!db.films.ready())
+    db.films.build(db);
+
+  const char* ext = k == export_format::csr ? ".csr" : ".el";
+  write_names(db.actors, prefix + ".actors", s);
+  write_names(db.movies, prefix + ".movies", s);
+  write_roles(db, prefix + ".roles" + ext, k, s);
+  if (costars)
+    write_costars(db, prefix + ".costars" + ext, k, threads, s);
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  s.seconds = dt.count();
+  return s;
+}
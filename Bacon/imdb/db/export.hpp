@@ -0,0 +1,60 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_EXPORT_HPP
+#define IMDB_EXPORT_HPP
+
+#include <cstdint>
+#include <string>
+
+struct database;
+
+
+// Binary exports of the graph for other tools.
+//
+// Given a prefix p, the export writes the names of actors and movies to
+// p.actors and p.movies, one per line in id order, and the distinct
+// actor-movie pairs to p.roles.el or p.roles.csr. Co-star edges between
+// actors that shared a movie can be written too, to p.costars.el or
+// p.costars.csr.
+//
+// Every binary file starts with an export_header, and all numbers are in
+// the machine's byte order. An edge list (.el) is a sequence of uint32
+// pairs, sorted; co-star pairs are listed once each, with the smaller id
+// first. A CSR file (.csr) holds rows + 1 uint64 offsets followed by the
+// uint32 column ids of each row in order; co-star rows list every co-star,
+// so each edge appears in both directions.
+//
+// Each file is streamed through a large buffer in one sequential pass.
+// Co-stars are found by a pool of threads, a window of actors at a time,
+// and written in order as each window completes.
+
+enum class export_format
+{
+  edges,
+  csr,
+};
+
+struct export_header
+{
+  char magic[8];         // "IMDB-EL\0" or "IMDB-CSR"; not a C string,
+                         // so readers compare all 8 bytes
+  std::uint32_t rows;    // Actors
+  std::uint32_t columns; // Movies, or actors for co-stars
+  std::uint64_t edges;   // Pairs, or entries of the column array
+};
+
+struct export_stats
+{
+  long roles = 0;   // Distinct actor-movie pairs
+  long costars = 0; // Co-star entries, if written
+  long bytes = 0;
+  double seconds = 0;
+  std::string error; // Empty on success
+};
+
+export_stats export_graph(database& db, const std::string& prefix,
+                          export_format f, bool costars, int threads = 0);
+
+
+#endif
@@ -0,0 +1,33 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "films.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+
+void
+filmographies::build(const database& db) {
+  int n = db.actors.size();
+  first.assign(1, 0);
+  first.reserve(n + 1);
+  movies.clear();
+  movies.reserve(db.roles.size());
+  for (int a = 0; a < n; ++a) {
+    auto start = movies.end() - movies.begin();
+    for (int x : db.actors[a].roles)
+      movies.push_back(db.roles[x].movie);
+
+    // An actor can play several parts in one movie.
+    std::sort(movies.begin() + start, movies.end());
+    movies.erase(std::unique(movies.begin() + start, movies.end()),
+                 movies.end());
+    first.push_back(movies.size());
+  }
+}
+
+void
+filmographies::clear() {
+  first.clear();
+  movies.clear();
+}
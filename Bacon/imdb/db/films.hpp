@@ -0,0 +1,35 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_FILMS_HPP
+#define IMDB_FILMS_HPP
+
+#include <vector>
+
+struct database;
+
+
+// The distinct movies of every actor, sorted by id and stored back to
+// back, so that the films two actors share can be found by intersecting
+// two contiguous lists (see intersect.hpp).
+//
+// Adding actors or roles clears the lists; the database rebuilds them on
+// the next query.
+struct filmographies
+{
+  void build(const database& db);
+  void clear();
+
+  // Returns true if the lists have been built.
+  bool ready() const { return !first.empty(); }
+
+  // The movies of actor a.
+  const int* begin(int a) const { return movies.data() + first[a]; }
+  int size(int a) const { return first[a + 1] - first[a]; }
+
+  std::vector<int> first;  // Offset of each actor's list, and the end
+  std::vector<int> movies; // Movie ids
+};
+
+
+#endif
@@ -0,0 +1,37 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "filter.hpp"
+
+unsigned
+kind_named(const std::string& s) {
+  if (s == "film")
+    return kind_film;
+  if (s == "tv")
+    return kind_tv;
+  if (s == "video")
+    return kind_video;
+  if (s == "game")
+    return kind_game;
+  if (s == "series")
+    return kind_series;
+  if (s == "episode")
+    return kind_episode;
+  return 0;
+}
+
+movie_mask::movie_mask(const movie_table& movies, const movie_filter& f)
+  : bits((movies.size() + 63) / 64, 0)
+{
+  for (int m = 0; m < movies.size(); ++m)
+    if (f(movies[m]))
+      bits[m >> 6] |= std::uint64_t(1) << (m & 63);
+}
+
+int
+movie_mask::count() const {
+  int n = 0;
+  for (std::uint64_t w : bits)
+    n += __builtin_popcountll(w);
+  return n;
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_FILTER_HPP
+#define IMDB_FILTER_HPP
+
+#include "movies.hpp"
+
+#include <cstdint>
+#include <string>
+
+
+// A predicate over movies: a range of release years and a set of kinds.
+// Movies with an unknown year only pass when the range starts at 0.
+struct movie_filter
+{
+  bool operator()(const movie& m) const {
+    return first <= m.year && m.year <= last && (kinds & m.kind);
+  }
+
+  int first = 0;
+  int last = 9999;
+  unsigned kinds = all_kinds;
+};
+
+// Returns the kind named by s (film, tv, video, game, series, episode),
+// or 0 if there is none.
+unsigned kind_named(const std::string& s);
+
+
+// A filter compiled into one bit per movie. It is built once per query so
+// that the search only needs a single bit test per movie.
+struct movie_mask
+{
+  movie_mask(const movie_table& movies, const movie_filter& f);
+
+  bool test(int m) const { return (bits[m >> 6] >> (m & 63)) & 1; }
+
+  // Returns the number of movies that pass.
+  int count() const;
+
+  std::vector<std::uint64_t> bits;
+};
+
+
+#endif
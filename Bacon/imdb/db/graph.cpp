@@ -0,0 +1,28 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "graph.hpp"
+
+void
+frontier::to_dense() {
+  if (dense)
+    return;
+  bits.assign(n, 0);
+  for (int v : list)
+    bits[v] = 1;
+  list.clear();
+  dense = true;
+}
+
+void
+frontier::to_sparse() {
+  if (!dense)
+    return;
+  list.clear();
+  list.reserve(count);
+  for (int v = 0; v < n; ++v)
+    if (bits[v])
+      list.push_back(v);
+  bits.clear();
+  dense = false;
+}
@@ -0,0 +1,242 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_GRAPH_HPP
+#define IMDB_GRAPH_HPP
+
+#include "query.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+// A small framework for parallel graph algorithms, after Ligra.
+//
+// Algorithms are written as operations on sets of active vertices
+// (frontiers). edge_map applies an update along every edge leaving the
+// frontier and returns the vertices that changed; vertex_map applies a
+// function to every vertex of a frontier. Both run in parallel.
+//
+// edge_map picks its direction for each step. A small frontier pushes:
+// each of its vertices updates its neighbors, racing with other threads,
+// so updates must be atomic. A large frontier pulls: each vertex that
+// still wants an update scans its neighbors for frontier members and
+// stops at the first that succeeds, which touches far fewer edges once
+// most of the graph is active, and needs no atomics since every vertex is
+// written by one thread only.
+//
+// An edge function F provides:
+//
+//    bool cond(int v)               v still accepts updates
+//    bool update(int u, int v)      pull along u -> v; true if v changed
+//    bool update_atomic(int u, int v)
+//                                   push along u -> v, safely against
+//                                   concurrent updates of v; true for at
+//                                   most one update of v per step
+
+
+// Returns the number of threads to use for a request of t, where 0 asks
+// for one per core.
+inline int
+thread_count(int t) {
+  return t > 0 ? t : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Calls f(lo, hi, t) for consecutive blocks of [0, n). Threads take blocks
+// from a shared counter, so uneven blocks balance out; t is the index of
+// the calling thread. No more threads are started than there are blocks.
+template<typename F>
+void
+parallel_blocks(int n, int block, int threads, F f) {
+  threads = std::max(1, std::min(threads, (n + block - 1) / block));
+  std::atomic<int> next(0);
+  auto work = [&](int t) {
+    int lo;
+    while ((lo = next.fetch_add(block)) < n)
+      f(lo, std::min(n, lo + block), t);
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(work, t);
+  work(0);
+  for (std::thread& t : pool)
+    t.join();
+}
+
+
+// The actor-movie graph as one set of vertices, read in place from the
+// adjacency of a frozen_graph. Actors are vertices [0, actors) and movie f
+// is vertex actors + f. A role is an edge in both directions. An actor's
+// neighbors are stored as movie ids, so each id in a neighbor list is
+// shifted by offset(v) to give a vertex.
+struct vertex_graph
+{
+  explicit vertex_graph(const frozen_graph& g)
+    : g(g), actors(g.actors()), movies(g.movies())
+  { }
+
+  int size() const { return actors + movies; }
+  long edges() const { return 2 * long(g.actor_movie.size()); }
+
+  int degree(int v) const { return end(v) - begin(v); }
+
+  const int* begin(int v) const {
+    if (is_movie(v))
+      return g.movie_actor.data() + g.movie_first[v - actors];
+    return g.actor_movie.data() + g.actor_first[v];
+  }
+
+  const int* end(int v) const {
+    if (is_movie(v))
+      return g.movie_actor.data() + g.movie_first[v - actors + 1];
+    return g.actor_movie.data() + g.actor_first[v + 1];
+  }
+
+  int offset(int v) const { return is_movie(v) ? 0 : actors; }
+  bool is_movie(int v) const { return v >= actors; }
+
+  const frozen_graph& g;
+  int actors;
+  int movies;
+};
+
+
+// A set of vertices, stored either as a list (sparse) or as one byte per
+// vertex (dense).
+struct frontier
+{
+  explicit frontier(int n)
+    : n(n)
+  { }
+
+  // A frontier holding only v.
+  static frontier single(int n, int v) {
+    frontier f(n);
+    f.list.push_back(v);
+    f.count = 1;
+    return f;
+  }
+
+  bool empty() const { return count == 0; }
+  int size() const { return count; }
+
+  void to_dense();
+  void to_sparse();
+
+  int n;
+  int count = 0;
+  bool dense = false;
+  std::vector<int> list;
+  std::vector<unsigned char> bits;
+};
+
+
+// How edge_map spent its steps.
+struct edge_map_stats
+{
+  int push = 0;
+  int pull = 0;
+};
+
+
+// A frontier is pulled once its vertices and their edges make up more
+// than this fraction of all edges.
+constexpr int pull_divisor = 20;
+
+constexpr int map_block = 1024;
+
+
+// Applies f to every vertex of the frontier.
+template<typename F>
+void
+vertex_map(const frontier& in, F f, int threads = 0) {
+  threads = thread_count(threads);
+  if (in.dense) {
+    parallel_blocks(in.n, map_block, threads, [&](int lo, int hi, int) {
+      for (int v = lo; v < hi; ++v)
+        if (in.bits[v])
+          f(v);
+    });
+  } else {
+    parallel_blocks(in.list.size(), map_block, threads, [&](int lo, int hi, int) {
+      for (int i = lo; i < hi; ++i)
+        f(in.list[i]);
+    });
+  }
+}
+
+// Applies f along the edges leaving the frontier and returns the vertices
+// for which an update succeeded.
+template<typename F>
+frontier
+edge_map(const vertex_graph& g, frontier& in, F& f, int threads = 0,
+         edge_map_stats* stats = nullptr) {
+  threads = thread_count(threads);
+  int n = g.size();
+  frontier out(n);
+
+  // Measure the work of pushing.
+  long work = in.size();
+  if (in.dense) {
+    for (int v = 0; v < n; ++v)
+      if (in.bits[v])
+        work += g.degree(v);
+  } else {
+    for (int v : in.list)
+      work += g.degree(v);
+  }
+
+  if (work > g.edges() / pull_divisor) {
+    if (stats)
+      ++stats->pull;
+    in.to_dense();
+    out.dense = true;
+    out.bits.assign(n, 0);
+    std::vector<int> counts(threads, 0);
+    parallel_blocks(n, map_block, threads, [&](int lo, int hi, int t) {
+      for (int v = lo; v < hi; ++v) {
+        if (!f.cond(v))
+          continue;
+        bool changed = false;
+        int off = g.offset(v);
+        for (const int* p = g.begin(v); p != g.end(v); ++p) {
+          if (in.bits[*p + off] && f.update(*p + off, v))
+            changed = true;
+          if (!f.cond(v))
+            break;
+        }
+        if (changed) {
+          out.bits[v] = 1;
+          ++counts[t];
+        }
+      }
+    });
+    for (int c : counts)
+      out.count += c;
+    return out;
+  }
+
+  if (stats)
+    ++stats->push;
+  in.to_sparse();
+  std::vector<std::vector<int>> found(threads);
+  parallel_blocks(in.list.size(), map_block / 4, threads,
+                  [&](int lo, int hi, int t) {
+    for (int i = lo; i < hi; ++i) {
+      int u = in.list[i];
+      int off = g.offset(u);
+      for (const int* p = g.begin(u); p != g.end(u); ++p)
+        if (f.cond(*p + off) && f.update_atomic(u, *p + off))
+          found[t].push_back(*p + off);
+    }
+  });
+  for (const std::vector<int>& part : found)
+    out.list.insert(out.list.end(), part.begin(), part.end());
+  out.count = out.list.size();
+  return out;
+}
+
+
+#endif
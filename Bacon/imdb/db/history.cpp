@@ -0,0 +1,88 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "history.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+void
+bacon_history::run(const database& db, int c, std::vector<int> ys) {
+  auto start = std::chrono::steady_clock::now();
+  center = c;
+  years = ys;
+  std::sort(years.begin(), years.end());
+  snapshots.clear();
+
+  // Release order of the movies with a known year.
+  std::vector<int> order;
+  for (int m = 0; m < db.movies.size(); ++m)
+    if (db.movies[m].year)
+      order.push_back(m);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return db.movies[a].year < db.movies[b].year;
+  });
+
+  // The distance of a movie is the least distance of its cast, so a movie
+  // only needs its cast rescanned when that value drops.
+  std::vector<unsigned char> dist(db.actors.size(), unreachable);
+  std::vector<unsigned char> mdist(db.movies.size(), unreachable);
+  std::vector<bool> released(db.movies.size(), false);
+  std::vector<std::vector<int>> q;
+  dist[c] = 0;
+
+  auto improve = [&](int w, int d) {
+    d = byte_distance(d);
+    if (d >= dist[w])
+      return;
+    dist[w] = d;
+    if (int(q.size()) <= d)
+      q.resize(d + 1);
+    q[d].push_back(w);
+  };
+
+  // Lowers the distance of a released movie and passes it on to the cast.
+  auto lower = [&](int m, int d) {
+    if (d >= mdist[m])
+      return;
+    mdist[m] = d;
+    for (int x : db.movies[m].roles)
+      improve(db.roles[x].actor, d + 1);
+  };
+
+  auto propagate = [&]() {
+    for (std::size_t d = 0; d < q.size(); ++d) {
+      for (std::size_t j = 0; j < q[d].size(); ++j) {
+        int u = q[d][j];
+        if (dist[u] != d)
+          continue;
+        for (int x : db.actors[u].roles) {
+          int m = db.roles[x].movie;
+          if (released[m])
+            lower(m, d);
+        }
+      }
+    }
+    q.clear();
+  };
+
+  std::size_t next = 0;
+  for (int y : years) {
+    for (; next < order.size() && db.movies[order[next]].year <= y; ++next) {
+      int m = order[next];
+      released[m] = true;
+      unsigned char d = unreachable;
+      for (int x : db.movies[m].roles)
+        d = std::min(d, dist[db.roles[x].actor]);
+      if (d != unreachable) {
+        lower(m, d);
+        propagate();
+      }
+    }
+    snapshots.push_back(dist);
+  }
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
@@ -0,0 +1,39 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_HISTORY_HPP
+#define IMDB_HISTORY_HPP
+
+#include "distance.hpp"
+
+#include <vector>
+
+struct database;
+
+
+// Distances from a center actor as they stood at the end of given years.
+//
+// Rather than running one search per year, movies are sorted by release
+// year and added to an initially empty graph one at a time. Each new movie
+// can only lower distances, so the improvement is passed on from its cast
+// through a distance-ordered queue, and a snapshot of every actor's
+// distance is taken as the sweep passes each requested year. Movies with
+// an unknown year are never added.
+struct bacon_history
+{
+  void run(const database& db, int center, std::vector<int> years);
+
+  // Returns the distance of actor a at the end of the i-th year.
+  int at(int a, int i) const {
+    unsigned char d = snapshots[i][a];
+    return d == unreachable ? -1 : d;
+  }
+
+  int center = -1;
+  std::vector<int> years;
+  std::vector<std::vector<unsigned char>> snapshots; // Years x actors
+  double seconds = 0;
+};
+
+
+#endif
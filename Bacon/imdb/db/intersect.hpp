@@ -0,0 +1,119 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_INTERSECT_HPP
+#define IMDB_INTERSECT_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+// Intersection of sorted lists of distinct ids.
+//
+// Lists of similar length are merged four ids at a time: each block of a
+// is compared against all four rotations of a block of b, which finds
+// every match between the two blocks in four vector comparisons, and the
+// block with the smaller last id is then skipped. When one list is much
+// longer than the other, each id of the short list is found in the long
+// one by galloping (exponential then binary search) from where the last
+// search stopped, which costs O(m log(n/m)) instead of O(m + n).
+//
+// If out is null, the matches are only counted.
+
+// Length ratio above which galloping beats merging.
+constexpr std::size_t gallop_ratio = 32;
+
+inline std::size_t
+intersect_gallop(const int* a, std::size_t na, const int* b, std::size_t nb,
+                 int* out) {
+  std::size_t k = 0;
+  const int* lo = b;
+  const int* end = b + nb;
+  for (std::size_t i = 0; i < na && lo != end; ++i) {
+    int x = a[i];
+    std::size_t step = 1;
+    const int* hi = lo;
+    while (hi < end && *hi < x) {
+      lo = hi + 1;
+      hi = lo + step < end ? lo + step : end;
+      step *= 2;
+    }
+    lo = std::lower_bound(lo, hi < end ? hi + 1 : end, x);
+    if (lo != end && *lo == x) {
+      if (out)
+        out[k] = x;
+      ++k;
+      ++lo;
+    }
+  }
+  return k;
+}
+
+inline std::size_t
+intersect_merge(const int* a, std::size_t na, const int* b, std::size_t nb,
+                int* out) {
+  std::size_t i = 0, j = 0, k = 0;
+#ifdef __SSE2__
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+    __m128i eq = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                   _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+      _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4e)),
+                   _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+    if (out) {
+      for (int m = mask; m; m &= m - 1)
+        out[k++] = a[i + __builtin_ctz(m)];
+    } else {
+      k += __builtin_popcount(mask);
+    }
+    int la = a[i + 3];
+    int lb = b[j + 3];
+    i += la <= lb ? 4 : 0;
+    j += lb <= la ? 4 : 0;
+  }
+#endif
+  while (i < na && j < nb) {
+    if (a[i] < b[j]) {
+      ++i;
+    } else if (b[j] < a[i]) {
+      ++j;
+    } else {
+      if (out)
+        out[k] = a[i];
+      ++k;
+      ++i;
+      ++j;
+    }
+  }
+  return k;
+}
+
+// Writes the ids in both a and b to out, which must have room for the
+// shorter list, and returns how many there are.
+inline std::size_t
+intersect(const int* a, std::size_t na, const int* b, std::size_t nb,
+          int* out) {
+  if (na > nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  if (na * gallop_ratio < nb)
+    return intersect_gallop(a, na, b, nb, out);
+  return intersect_merge(a, na, b, nb, out);
+}
+
+// Returns the number of ids in both a and b.
+inline std::size_t
+intersect_count(const int* a, std::size_t na, const int* b, std::size_t nb) {
+  return intersect(a, na, b, nb, nullptr);
+}
+
+
+#endif
@@ -0,0 +1,157 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "landmarks.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <numeric>
+#include <ostream>
+#include <random>
+
+// Chooses k landmarks and computes their distance vectors.
+void
+landmark_oracle::build(database& db, int k, strategy s) {
+  auto start = std::chrono::steady_clock::now();
+  int n = db.actors.size();
+  k = std::min(k, n);
+
+  // Rank actors by the number of roles they have played.
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return db.actors[a].roles.size() > db.actors[b].roles.size();
+  });
+
+  // Collect each landmark's distances as a column first; coverage needs
+  // to know which actors are near the landmarks chosen so far.
+  landmarks.clear();
+  std::vector<std::vector<unsigned char>> columns;
+  std::vector<bool> covered(n, false);
+  for (int a : order) {
+    if (size() == k)
+      break;
+    if (s == by_coverage && covered[a])
+      continue;
+
+    // The search goes through the cache, so it is shared with any shell
+    // queries against the same center.
+    bfs_ptr r = db.search(a);
+    landmarks.push_back(a);
+    columns.push_back(r->distance);
+    for (int b = 0; b < n; ++b)
+      if (r->distance[b] <= 1)
+        covered[b] = true;
+  }
+
+  // Transpose into actor-major rows.
+  k = size();
+  table.assign(std::size_t(n) * k, unreachable);
+  for (int i = 0; i < k; ++i)
+    for (int b = 0; b < n; ++b)
+      table[std::size_t(b) * k + i] = columns[i][b];
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  build_seconds = dt.count();
+}
+
+// Returns a lower bound on the distance between a and b, or -1 if they
+// are known to be disconnected.
+int
+landmark_oracle::lower(int a, int b) const {
+  const unsigned char* da = &table[std::size_t(a) * size()];
+  const unsigned char* db = &table[std::size_t(b) * size()];
+  int best = a != b;
+  for (int i = 0; i < size(); ++i) {
+    if ((da[i] == unreachable) != (db[i] == unreachable))
+      return -1;
+    if (da[i] != unreachable)
+      best = std::max(best, std::abs(int(da[i]) - int(db[i])));
+  }
+  return best;
+}
+
+// Returns an upper bound on the distance between a and b, or -1 if no
+// landmark reaches both of them.
+int
+landmark_oracle::upper(int a, int b) const {
+  if (a == b)
+    return 0;
+  const unsigned char* da = &table[std::size_t(a) * size()];
+  const unsigned char* db = &table[std::size_t(b) * size()];
+  int best = -1;
+  for (int i = 0; i < size(); ++i) {
+    if (da[i] == unreachable || db[i] == unreachable)
+      continue;
+    int d = int(da[i]) + int(db[i]);
+    if (best == -1 || d < best)
+      best = d;
+  }
+  return best;
+}
+
+// Returns the distance between a and b when the bounds meet, or -1 if
+// they are known to be disconnected. Otherwise returns the exact distance
+// if asked for it, and the upper bound (-1 if there is none) if not.
+int
+landmark_oracle::distance(database& db, int a, int b, bool exact) const {
+  int lo = lower(a, b);
+  if (lo == -1)
+    return -1;
+  int hi = upper(a, b);
+  if (lo == hi)
+    return hi;
+  return exact ? db.distance_between(a, b) : hi;
+}
+
+void
+evaluate(database& db, const landmark_oracle& lm, int pairs,
+         std::ostream& os) {
+  int n = db.actors.size();
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> pick(0, n - 1);
+  std::vector<std::pair<int, int>> sample(pairs);
+  for (auto& p : sample)
+    p = {pick(gen), pick(gen)};
+
+  // Time the bound queries on their own.
+  auto start = std::chrono::steady_clock::now();
+  volatile long sink = 0;
+  for (auto& p : sample)
+    sink += lm.lower(p.first, p.second) + lm.upper(p.first, p.second);
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+
+  // Compare against exact answers. The histogram counts how far the upper
+  // bound is above the true distance.
+  std::vector<int> error;
+  int exact = 0, disconnected = 0, unknown = 0;
+  for (auto& p : sample) {
+    int d = db.distance_between(p.first, p.second);
+    int lo = lm.lower(p.first, p.second);
+    int hi = lm.upper(p.first, p.second);
+    if (d == -1) {
+      ++disconnected;
+      continue;
+    }
+    if (hi == -1) {
+      ++unknown;
+      continue;
+    }
+    if (lo == hi)
+      ++exact;
+    if (hi - d >= int(error.size()))
+      error.resize(hi - d + 1);
+    ++error[hi - d];
+  }
+
+  os << "* " << lm.size() << " landmarks in " << lm.build_seconds << " s, "
+     << lm.bytes() / 1024 << " KiB\n";
+  os << "* " << pairs << " queries: "
+     << (pairs ? dt.count() * 1e9 / pairs : 0) << " ns/query\n";
+  os << "* " << exact << " exact, " << disconnected << " disconnected, "
+     << unknown << " unbounded\n";
+  for (std::size_t e = 0; e < error.size(); ++e)
+    os << "  upper bound +" << e << ": " << error[e] << '\n';
+}
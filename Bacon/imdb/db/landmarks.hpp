@@ -0,0 +1,62 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_LANDMARKS_HPP
+#define IMDB_LANDMARKS_HPP
+
+#include "distance.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// An approximate distance oracle over the actor graph.
+//
+// A small set of landmark actors is chosen and a breadth-first search is
+// run from each. For any two actors a and b and landmark l, the triangle
+// inequality gives
+//
+//    |d(a, l) - d(l, b)| <= d(a, b) <= d(a, l) + d(l, b)
+//
+// so the tightest bounds over all landmarks bracket the true distance.
+// Distances are stored actor-major as bytes, so a query touches two
+// contiguous rows of k bytes each.
+struct landmark_oracle
+{
+  // How landmarks are chosen.
+  enum strategy {
+    by_degree,   // The k actors with the most roles
+    by_coverage, // High-degree actors not adjacent to an earlier landmark
+  };
+
+  void build(database& db, int k, strategy s);
+
+  // Returns the number of landmarks.
+  int size() const { return landmarks.size(); }
+
+  // Returns the number of bytes used by the distance table.
+  std::size_t bytes() const { return table.size(); }
+
+  // Returns the distance from actor a to the i-th landmark.
+  unsigned char at(int a, int i) const { return table[std::size_t(a) * size() + i]; }
+
+  int lower(int a, int b) const;
+  int upper(int a, int b) const;
+  int distance(database& db, int a, int b, bool exact) const;
+
+  std::vector<int> landmarks;
+  std::vector<unsigned char> table; // Actors x landmarks
+  double build_seconds = 0;
+};
+
+
+// Compares the oracle's bounds against exact distances for a random sample
+// of actor pairs and writes the error distribution to os.
+void evaluate(database& db, const landmark_oracle& lm, int pairs,
+              std::ostream& os);
+
+
+#endif
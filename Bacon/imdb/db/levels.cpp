@@ -0,0 +1,94 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "levels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+// Claims each vertex for the first frontier vertex to reach it. The hop
+// count is stamped afterwards on the whole new frontier at once.
+struct reach
+{
+  bool cond(int v) const {
+    return parent[v].load(std::memory_order_relaxed) == -1;
+  }
+
+  bool update(int u, int v) {
+    parent[v].store(u, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool update_atomic(int u, int v) {
+    int expected = -1;
+    return parent[v].compare_exchange_strong(expected, u,
+                                             std::memory_order_relaxed);
+  }
+
+  std::vector<std::atomic<int>>& parent;
+};
+
+} // namespace
+
+void
+levels::run(const vertex_graph& g, int c, int threads) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::atomic<int>> parent(g.size());
+  for (std::atomic<int>& p : parent)
+    p.store(-1, std::memory_order_relaxed);
+  std::vector<int> hops(g.size(), -1);
+  parent[c] = c;
+  hops[c] = 0;
+
+  reach f{parent};
+  steps = edge_map_stats();
+  frontier active = frontier::single(g.size(), c);
+  for (int h = 1; !active.empty(); ++h) {
+    active = edge_map(g, active, f, threads, &steps);
+    vertex_map(active, [&](int v) { hops[v] = h; }, threads);
+  }
+
+  // Actors and movies alternate, so an actor's distance is half its hops.
+  center = c;
+  distance.assign(g.actors, -1);
+  count.clear();
+  for (int a = 0; a < g.actors; ++a) {
+    if (hops[a] == -1)
+      continue;
+    distance[a] = hops[a] / 2;
+    if (distance[a] >= int(count.size()))
+      count.resize(distance[a] + 1);
+    ++count[distance[a]];
+  }
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
+
+int
+levels::check(const std::vector<int>& expected) const {
+  int wrong = 0;
+  for (std::size_t a = 0; a < distance.size(); ++a)
+    if (a >= expected.size() || expected[a] != distance[a])
+      ++wrong;
+  return wrong;
+}
+
+void
+levels::report(std::ostream& os) const {
+  long reached = 0;
+  double sum = 0;
+  for (std::size_t d = 0; d < count.size(); ++d) {
+    reached += count[d];
+    sum += double(d) * count[d];
+  }
+  os << "* " << reached << " actors reached in " << seconds * 1e3 << " ms ("
+     << steps.push << " push and " << steps.pull << " pull steps); mean "
+     << sum / std::max(1L, reached) << '\n';
+  for (std::size_t d = 0; d < count.size(); ++d)
+    os << "  " << d << ": " << count[d] << '\n';
+}
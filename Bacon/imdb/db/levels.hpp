@@ -0,0 +1,35 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_LEVELS_HPP
+#define IMDB_LEVELS_HPP
+
+#include "graph.hpp"
+
+#include <iosfwd>
+#include <vector>
+
+
+// Distances from one actor to every other, by a breadth-first search
+// written on the graph framework. Early levels push from the few actors
+// and movies just reached; once the frontier is large, the search pulls,
+// and each unreached vertex stops at its first neighbor in the frontier.
+struct levels
+{
+  void run(const vertex_graph& g, int c, int threads = 0);
+
+  // Returns the number of actors whose distance differs from expected.
+  int check(const std::vector<int>& expected) const;
+
+  // Prints how many actors are at each distance.
+  void report(std::ostream& os) const;
+
+  int center = -1;
+  std::vector<int> distance; // In actors; -1 if unreachable
+  std::vector<int> count;    // Actors at each distance
+  edge_map_stats steps;
+  double seconds = 0;
+};
+
+
+#endif
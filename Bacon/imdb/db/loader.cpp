@@ -0,0 +1,161 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "loader.hpp"
+#include "db.hpp"
+
+#include "../imdb/actor_parser.hpp"
+#include "../imdb/movie_parser.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+struct movie_visitor
+{
+  movie_visitor(database& db)
+    : db(db)
+  { }
+
+  // Nothing to do.
+  void on_movie(const char* m) { }
+
+  // Save each movie.
+  void on_row(const char* n, const char* y) {
+    db.add_movie(n, y);
+  }
+
+  database& db;
+};
+
+struct actor_visitor
+{
+  actor_visitor(database& db)
+    : db(db)
+  { }
+
+  void on_actor(const char* n) {
+    db.add_actor(n);
+  }
+
+  void on_row(const char* act, const char* mov, const char* info) {
+    db.add_role(act, mov, info);
+  }
+
+  database& db;
+};
+
+} // namespace
+
+loader::~loader() {
+  if (worker.joinable())
+    worker.join();
+}
+
+void
+loader::start(std::ostream& log, const vertex_order* order, bool distances) {
+  worker = std::thread(&loader::run, this, std::ref(log), order, distances);
+}
+
+void
+loader::wait() {
+  std::unique_lock<std::mutex> lock(m);
+  cv.wait(lock, [&] { return finished; });
+}
+
+const char*
+loader::status() const {
+  switch (phase()) {
+  case loading: return "loading movies";
+  case movies_ready: return "loading actors";
+  case actors_ready: return "building the graph";
+  case graph_ready: return "computing distances";
+  case distances_ready: return "ready";
+  case load_failed: return "failed";
+  }
+  return "";
+}
+
+void
+loader::publish(load_phase p) {
+  current.store(p, std::memory_order_release);
+  if (p == distances_ready || p == load_failed) {
+    std::lock_guard<std::mutex> lock(m);
+    finished = true;
+    cv.notify_all();
+  }
+}
+
+void
+loader::run(std::ostream& log, const vertex_order* order, bool distances) {
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&]() {
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+    return dt.count();
+  };
+
+  try {
+    // Actually parse the content.
+    movie_visitor movie_vis(db);
+    actor_visitor actor_vis(db);
+
+    imdb::movie_parser<movie_visitor> movie_parser("movies.list", movie_vis);
+    imdb::actor_parser<actor_visitor> actor_parser("actors.list", actor_vis);
+    imdb::actor_parser<actor_visitor> actress_parser("actresses.list",
+                                                     actor_vis);
+
+    log << "* loading movies\n";
+    movie_parser.parse();
+    log << "* loaded " << db.movies.size() << " movies after " << elapsed()
+        << " s\n";
+    if (!order)
+      publish(movies_ready);
+
+    log << "* loading actors\n";
+    actor_parser.parse();
+    log << "* loading actresses\n";
+    actress_parser.parse();
+    log << "* loaded " << db.actors.size() << " actors after " << elapsed()
+        << " s\n";
+
+    // Diagnose lookup errors. These happens when an actor row refers
+    // to a movie title that was not parsed in the movie data set.
+    if (db.movie_lookup_errors)
+      std::cerr << "! " << db.movie_lookup_errors << " movie lookup errors\n";
+
+    if (order)
+      report(reorder(db, *order), log);
+    db.actor_names.build(db.actors);
+    db.movie_names.build(db.movies);
+    log << "* indexed " << db.actor_names.size() + db.movie_names.size()
+        << " names in "
+        << (db.actor_names.bytes() + db.movie_names.bytes()) / (1 << 20)
+        << " MiB after " << elapsed() << " s\n";
+    db.films.build(db);
+
+    int kb = db.find_actor(default_center);
+    log << "* index of \"" << default_center << "\": " << kb << '\n';
+    publish(actors_ready);
+
+    // Find the connected components so that queries between disconnected
+    // actors can be answered without a search.
+    db.parts.run(db);
+    db.parts.report(log);
+    publish(graph_ready);
+    if (!distances) {
+      publish(distances_ready);
+      return;
+    }
+
+    //set bacon numbers, then keep them current as roles arrive
+    db.BaconNumber();
+    db.dynamic = true;
+    log << "* distances ready after " << elapsed() << " s\n";
+    publish(distances_ready);
+  } catch (std::exception& e) {
+    error = e.what();
+    publish(load_failed);
+  }
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_LOADER_HPP
+#define IMDB_LOADER_HPP
+
+#include "reorder.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct database;
+
+
+// Milestones of loading, in order. Each one publishes data that is
+// complete and will not change again until loading finishes.
+enum load_phase : int
+{
+  loading,        // Nothing is available yet
+  movies_ready,   // Movie names, years, and kinds
+  actors_ready,   // Actor names and roles
+  graph_ready,    // Components, and the reordering if one was asked for
+  distances_ready, // Distances and paths from the default center
+  load_failed,
+};
+
+
+// Loads the data files on a background thread.
+//
+// Queries check the current phase before touching the database and answer
+// "loading" if their data is not complete, so the shell can serve name and
+// movie lookups long before the whole graph is built. Movie rows are not
+// moved while actors load (only their cast lists grow), which is why movie
+// queries are safe from the first milestone on. If a reordering is asked
+// for, it renumbers the movies too, so the movie milestone is held back
+// until it is done.
+struct loader
+{
+  explicit loader(database& db)
+    : db(db)
+  { }
+
+  ~loader();
+
+  // Starts loading. If distances is false, loading stops at graph_ready.
+  void start(std::ostream& log, const vertex_order* order, bool distances);
+
+  load_phase phase() const { return current.load(std::memory_order_acquire); }
+  bool ready(load_phase p) const { return phase() >= p && !failed(); }
+  bool failed() const { return phase() == load_failed; }
+
+  // Blocks until loading finishes or fails.
+  void wait();
+
+  // Returns a description of what is being loaded.
+  const char* status() const;
+
+  database& db;
+  std::string error; // Set before load_failed is published
+
+private:
+  void run(std::ostream& log, const vertex_order* order, bool distances);
+  void publish(load_phase p);
+
+  std::atomic<load_phase> current{loading};
+  std::mutex m;
+  std::condition_variable cv;
+  bool finished = false;
+  std::thread worker;
+};
+
+
+#endif
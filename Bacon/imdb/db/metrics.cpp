@@ -0,0 +1,212 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "metrics.hpp"
+
+#ifdef IMDB_METRICS
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace metrics {
+
+namespace {
+
+constexpr int sub_bits = 4;
+constexpr int sub_buckets = 1 << sub_bits;
+constexpr int buckets = (64 - sub_bits + 1) << sub_bits;
+
+const char* probe_names[probes] = {
+  "lookup", "search", "bfs", "meet", "common", "path", "output",
+  "request",
+};
+
+const char* counter_names[counters] = {
+  "actors visited", "bytes written",
+};
+
+// Values below 16 have their own bucket. Above that, the bucket is the
+// position of the top bit and the next four bits below it.
+int
+bucket_of(std::uint64_t v) {
+  if (v < sub_buckets)
+    return v;
+  int e = 63 - __builtin_clzll(v);
+  return (e - sub_bits + 1) << sub_bits |
+         ((v >> (e - sub_bits)) & (sub_buckets - 1));
+}
+
+// Returns the largest value that falls in bucket b.
+std::uint64_t
+highest(int b) {
+  if (b < sub_buckets)
+    return b;
+  int e = (b >> sub_bits) + sub_bits - 1;
+  std::uint64_t low = std::uint64_t(sub_buckets + (b & (sub_buckets - 1)))
+                      << (e - sub_bits);
+  return low + (std::uint64_t(1) << (e - sub_bits)) - 1;
+}
+
+// Only the owning thread writes a histogram, so updates are plain loads
+// and stores; the atomics only make concurrent reports well defined.
+struct histogram
+{
+  void record(std::uint64_t v) {
+    bump(counts[bucket_of(v)], 1);
+    bump(total, 1);
+    bump(sum, v);
+    if (v > max.load(std::memory_order_relaxed))
+      max.store(v, std::memory_order_relaxed);
+  }
+
+  static void bump(std::atomic<std::uint64_t>& x, std::uint64_t n) {
+    x.store(x.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  std::atomic<std::uint64_t> counts[buckets] = {};
+  std::atomic<std::uint64_t> total{0};
+  std::atomic<std::uint64_t> sum{0};
+  std::atomic<std::uint64_t> max{0};
+};
+
+struct block
+{
+  histogram probe[probes];
+  std::atomic<std::uint64_t> count[counters] = {};
+};
+
+// A plain copy of histograms, summed over threads.
+struct summary
+{
+  void add(const histogram& h) {
+    for (int b = 0; b < buckets; ++b)
+      counts[b] += h.counts[b].load(std::memory_order_relaxed);
+    total += h.total.load(std::memory_order_relaxed);
+    sum += h.sum.load(std::memory_order_relaxed);
+    max = std::max<std::uint64_t>(max, h.max.load(std::memory_order_relaxed));
+  }
+
+  // Returns the value below which the fraction q of samples fall.
+  std::uint64_t percentile(double q) const {
+    std::uint64_t rank = q * total;
+    std::uint64_t seen = 0;
+    for (int b = 0; b < buckets; ++b) {
+      seen += counts[b];
+      if (seen > rank)
+        return std::min(highest(b), max);
+    }
+    return max;
+  }
+
+  std::uint64_t counts[buckets] = {};
+  std::uint64_t total = 0;
+  std::uint64_t sum = 0;
+  std::uint64_t max = 0;
+};
+
+// Blocks of running threads, and the totals of threads that have exited.
+std::mutex registry;
+std::vector<block*> live;
+summary retired[probes];
+std::uint64_t retired_count[counters];
+
+struct owner
+{
+  owner()
+    : b(new block)
+  {
+    std::lock_guard<std::mutex> lock(registry);
+    live.push_back(b);
+  }
+
+  ~owner() {
+    std::lock_guard<std::mutex> lock(registry);
+    for (int p = 0; p < probes; ++p)
+      retired[p].add(b->probe[p]);
+    for (int c = 0; c < counters; ++c)
+      retired_count[c] += b->count[c].load(std::memory_order_relaxed);
+    live.erase(std::find(live.begin(), live.end(), b));
+    delete b;
+  }
+
+  block* b;
+};
+
+block&
+local() {
+  thread_local owner o;
+  return *o.b;
+}
+
+} // namespace
+
+void
+record(probe p, std::uint64_t ns) {
+  local().probe[p].record(ns);
+}
+
+void
+add(counter c, std::uint64_t n) {
+  histogram::bump(local().count[c], n);
+}
+
+void
+report(std::ostream& os) {
+  std::lock_guard<std::mutex> lock(registry);
+  auto us = [](std::uint64_t ns) { return ns / 1e3; };
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << "* latency in us:       count      mean       p50       p90"
+     << "       p99     p99.9       max\n";
+  for (int p = 0; p < probes; ++p) {
+    summary s = retired[p];
+    for (block* b : live)
+      s.add(b->probe[p]);
+    if (!s.total)
+      continue;
+    os << "  " << std::left << std::setw(12) << probe_names[p] << std::right
+       << std::setw(14) << s.total << std::fixed << std::setprecision(2)
+       << std::setw(10) << us(s.sum) / s.total
+       << std::setw(10) << us(s.percentile(0.5))
+       << std::setw(10) << us(s.percentile(0.9))
+       << std::setw(10) << us(s.percentile(0.99))
+       << std::setw(10) << us(s.percentile(0.999))
+       << std::setw(10) << us(s.max) << '\n';
+  }
+  os.flags(flags);
+  os.precision(precision);
+  for (int c = 0; c < counters; ++c) {
+    std::uint64_t n = retired_count[c];
+    for (block* b : live)
+      n += b->count[c].load(std::memory_order_relaxed);
+    if (n)
+      os << "  " << counter_names[c] << ": " << n << '\n';
+  }
+}
+
+void
+reset() {
+  std::lock_guard<std::mutex> lock(registry);
+  for (int p = 0; p < probes; ++p)
+    retired[p] = summary();
+  for (int c = 0; c < counters; ++c)
+    retired_count[c] = 0;
+  for (block* b : live) {
+    for (histogram& h : b->probe) {
+      for (auto& x : h.counts)
+        x.store(0, std::memory_order_relaxed);
+      h.total.store(0, std::memory_order_relaxed);
+      h.sum.store(0, std::memory_order_relaxed);
+      h.max.store(0, std::memory_order_relaxed);
+    }
+    for (auto& x : b->count)
+      x.store(0, std::memory_order_relaxed);
+  }
+}
+
+} // namespace metrics
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_METRICS_HPP
+#define IMDB_METRICS_HPP
+
+// Latency histograms and counters for the query paths.
+//
+// Each thread records into its own block of histograms, so recording is a
+// clock read and a few uncontended stores. Histograms are log-linear, like
+// HdrHistogram: 16 linear buckets per power of two, which bounds the error
+// of any reported percentile by 1/16 of its value.
+//
+// Building with IMDB_METRICS undefined removes all of it; the IMDB_TIME
+// and IMDB_COUNT macros expand to nothing.
+
+#ifdef IMDB_METRICS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+namespace metrics {
+
+// Timed operations.
+enum probe : int
+{
+  lookup,   // Name to id lookups
+  search,   // Searches answered from the cache or by exploring
+  bfs,      // Full breadth-first searches
+  meet,     // Bidirectional distance searches
+  common,   // Shared filmography queries
+  path,     // Path reconstruction
+  output,   // Formatting and writing results
+  request,  // Whole batch or server queries
+  probes,
+};
+
+// Event counts.
+enum counter : int
+{
+  actors_visited, // Actors reached by full searches
+  bytes_written,  // Bytes of batch and server results
+  counters,
+};
+
+// Records a latency, in nanoseconds, for the calling thread.
+void record(probe p, std::uint64_t ns);
+
+// Adds to a counter for the calling thread.
+void add(counter c, std::uint64_t n);
+
+// Prints counts, means, and percentiles summed over all threads.
+void report(std::ostream& os);
+
+// Clears every histogram and counter. Updates racing with the reset may
+// survive it.
+void reset();
+
+// Records the lifetime of a scope.
+struct timer
+{
+  explicit timer(probe p)
+    : p(p), start(std::chrono::steady_clock::now())
+  { }
+
+  ~timer() {
+    auto dt = std::chrono::steady_clock::now() - start;
+    record(p, std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+  }
+
+  probe p;
+  std::chrono::steady_clock::time_point start;
+};
+
+} // namespace metrics
+
+#define IMDB_METRICS_CAT_(a, b) a##b
+#define IMDB_METRICS_VAR_(n) IMDB_METRICS_CAT_(metrics_timer_, n)
+#define IMDB_TIME(p) metrics::timer IMDB_METRICS_VAR_(__LINE__)(metrics::p)
+#define IMDB_COUNT(c, n) metrics::add(metrics::c, n)
+
+#else
+
+#define IMDB_TIME(p) ((void)0)
+#define IMDB_COUNT(c, n) ((void)0)
+
+#endif
+
+
+#endif
@@ -2,3 +2,34 @@
 // All rights reserved
 
 #include "movies.hpp"
+
+#include <cctype>
+
+int
+parse_year(const char* y) {
+  int n = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (!std::isdigit(static_cast<unsigned char>(y[i])))
+      return 0;
+    n = n * 10 + (y[i] - '0');
+  }
+  return n;
+}
+
+movie_kind
+parse_kind(const char* name) {
+  if (name[0] == '"')
+    return std::strchr(name, '{') ? kind_episode : kind_series;
+  std::size_t n = std::strlen(name);
+  auto ends_with = [&](const char* s) {
+    std::size_t k = std::strlen(s);
+    return n >= k && !std::strcmp(name + n - k, s);
+  };
+  if (ends_with("(TV)"))
+    return kind_tv;
+  if (ends_with("(V)"))
+    return kind_video;
+  if (ends_with("(VG)"))
+    return kind_game;
+  return kind_film;
+}
@@ -7,6 +7,29 @@
 #include "table.hpp"
 
 
+// Returns the (first) year in a release date string, or 0 if the year is
+// unknown. Series give a range of years, e.g. "1994-2004" or "2010-????".
+int parse_year(const char* y);
+
+
+// The kinds of production, as bits so that sets of kinds can be formed.
+enum movie_kind : unsigned char
+{
+  kind_film = 1,
+  kind_tv = 2,
+  kind_video = 4,
+  kind_game = 8,
+  kind_series = 16,
+  kind_episode = 32,
+  all_kinds = 63,
+};
+
+// Returns the kind of production from its title. Serial productions are
+// quoted, and episodes carry a {subtitle}. Other kinds are marked by a
+// trailing (TV), (V), or (VG).
+movie_kind parse_kind(const char* name);
+
+
 // Represents a movie, tv episode, or video game.
 struct movie
 {
@@ -14,14 +37,15 @@ struct movie
   movie() = default;
 
   movie(const char* n, const char* y)
-    : name(n), year(y)
+    : name(n), year(parse_year(y)), kind(parse_kind(n))
   { }
 
   // Add the index of an actor's role in a movie to the cast.
   void add_role(int r) { roles.push_back(r); }
 
   std::string name;
-  std::string year;
+  int year = 0;
+  movie_kind kind = kind_film;
   std::vector<int> roles;
 };
 
@@ -0,0 +1,393 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "names.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+namespace {
+
+constexpr int gram_bits = 20;
+constexpr std::uint32_t gram_buckets = 1u << gram_bits;
+
+// Lower case, without quotes.
+std::string
+fold(const std::string& s) {
+  std::string r;
+  r.reserve(s.size());
+  for (char c : s) {
+    if (c == '"')
+      continue;
+    r += std::tolower(static_cast<unsigned char>(c));
+  }
+  return r;
+}
+
+// Returns the length of s without a trailing " (I)" or " (1994)".
+std::size_t
+stem(const std::string& s) {
+  if (s.empty() || s.back() != ')')
+    return s.size();
+  std::size_t open = s.rfind(" (");
+  if (open == std::string::npos)
+    return s.size();
+  for (std::size_t i = open + 2; i + 1 < s.size(); ++i) {
+    char c = s[i];
+    if (!std::isdigit(static_cast<unsigned char>(c)) &&
+        c != 'i' && c != 'v' && c != 'x' && c != '/' && c != '?')
+      return s.size();
+  }
+  return open;
+}
+
+std::uint32_t
+gram(const char* p) {
+  std::uint32_t g = static_cast<unsigned char>(p[0]) << 16 |
+                    static_cast<unsigned char>(p[1]) << 8 |
+                    static_cast<unsigned char>(p[2]);
+  return (g * 2654435761u) >> (32 - gram_bits);
+}
+
+// Appends the trigram buckets of s, padded with two marks on either side
+// so that short keys still have grams.
+void
+grams(const char* s, int n, std::vector<std::uint32_t>& out) {
+  std::string p = "\1\1";
+  p.append(s, n);
+  p += "\1\1";
+  for (std::size_t i = 0; i + 3 <= p.size(); ++i)
+    out.push_back(gram(p.data() + i));
+}
+
+// Edit distance between a pattern of at most 64 characters and s, using
+// Myers' bit-vector algorithm. Each column of the dynamic program is a
+// pair of bit vectors of vertical deltas.
+struct myers
+{
+  explicit myers(const std::string& p)
+    : m(p.size())
+  {
+    std::fill(peq, peq + 256, 0);
+    for (int i = 0; i < m; ++i)
+      peq[static_cast<unsigned char>(p[i])] |= std::uint64_t(1) << i;
+  }
+
+  int distance(const char* s, int n) const {
+    if (m == 0)
+      return n;
+    std::uint64_t last = std::uint64_t(1) << (m - 1);
+    std::uint64_t pv = ~std::uint64_t(0);
+    std::uint64_t mv = 0;
+    int score = m;
+    for (int j = 0; j < n; ++j) {
+      std::uint64_t eq = peq[static_cast<unsigned char>(s[j])];
+      std::uint64_t xv = eq | mv;
+      std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+      std::uint64_t ph = mv | ~(xh | pv);
+      std::uint64_t mh = pv & xh;
+      if (ph & last)
+        ++score;
+      else if (mh & last)
+        --score;
+      // The top row grows by one per column.
+      ph = (ph << 1) | 1;
+      mh <<= 1;
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+    }
+    return score;
+  }
+
+  int m;
+  std::uint64_t peq[256];
+};
+
+// Orders matches by distance, then weight, then id.
+bool
+better(const name_match& a, const name_match& b) {
+  if (a.edits != b.edits)
+    return a.edits < b.edits;
+  if (a.weight != b.weight)
+    return a.weight > b.weight;
+  return a.id < b.id;
+}
+
+bool
+contains(const std::vector<name_match>& v, int id) {
+  for (const name_match& m : v)
+    if (m.id == id)
+      return true;
+  return false;
+}
+
+} // namespace
+
+void
+name_search::clear() {
+  text.clear();
+  first.assign(1, 0);
+  ids.clear();
+  weights.clear();
+}
+
+void
+name_search::add(const std::string& name, int id, int weight) {
+  std::string full = fold(name);
+  std::string base = full.substr(0, stem(full));
+  std::string suffix = full.substr(base.size());
+
+  std::string keys[4] = {full, base};
+  std::size_t comma = base.find(", ");
+  if (comma != std::string::npos) {
+    keys[2] = base.substr(comma + 2) + ' ' + base.substr(0, comma);
+    keys[3] = keys[2] + suffix;
+  }
+  for (int i = 0; i < 4; ++i) {
+    if (keys[i].empty() || std::find(keys, keys + i, keys[i]) != keys + i)
+      continue;
+    text += keys[i];
+    first.push_back(text.size());
+    ids.push_back(id);
+    weights.push_back(weight);
+  }
+}
+
+void
+name_search::finish() {
+  int n = ids.size();
+
+  // Sort the keys.
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    int la = length(a);
+    int lb = length(b);
+    int c = std::memcmp(key(a), key(b), std::min(la, lb));
+    return c ? c < 0 : la < lb;
+  });
+  std::string sorted_text;
+  sorted_text.reserve(text.size());
+  std::vector<std::uint32_t> sorted_first(1, 0);
+  std::vector<int> sorted_ids(n);
+  std::vector<int> sorted_weights(n);
+  sorted_first.reserve(n + 1);
+  for (int i = 0; i < n; ++i) {
+    int e = order[i];
+    sorted_text.append(key(e), length(e));
+    sorted_first.push_back(sorted_text.size());
+    sorted_ids[i] = ids[e];
+    sorted_weights[i] = weights[e];
+  }
+  text.swap(sorted_text);
+  first.swap(sorted_first);
+  ids.swap(sorted_ids);
+  weights.swap(sorted_weights);
+
+  // Build the max tree over a power of two leaves.
+  int leaves = 1;
+  while (leaves < n)
+    leaves *= 2;
+  tree.assign(2 * leaves, -1);
+  for (int e = 0; e < n; ++e)
+    tree[leaves + e] = e;
+  for (int i = leaves - 1; i > 0; --i) {
+    int l = tree[2 * i];
+    int r = tree[2 * i + 1];
+    tree[i] = (r == -1 || (l != -1 && weights[l] >= weights[r])) ? l : r;
+  }
+
+  // Count and then fill the trigram postings.
+  gram_first.assign(gram_buckets + 1, 0);
+  std::vector<std::uint32_t> g;
+  for (int e = 0; e < n; ++e) {
+    g.clear();
+    grams(key(e), length(e), g);
+    std::sort(g.begin(), g.end());
+    g.erase(std::unique(g.begin(), g.end()), g.end());
+    for (std::uint32_t b : g)
+      ++gram_first[b + 1];
+  }
+  std::partial_sum(gram_first.begin(), gram_first.end(), gram_first.begin());
+  gram_entry.resize(gram_first.back());
+  std::vector<std::uint32_t> next(gram_first.begin(), gram_first.end() - 1);
+  for (int e = 0; e < n; ++e) {
+    g.clear();
+    grams(key(e), length(e), g);
+    std::sort(g.begin(), g.end());
+    g.erase(std::unique(g.begin(), g.end()), g.end());
+    for (std::uint32_t b : g)
+      gram_entry[next[b]++] = e;
+  }
+}
+
+std::vector<name_match>
+name_search::prefix(const std::string& q, int k) const {
+  std::vector<name_match> out;
+  if (!ready() || k <= 0)
+    return out;
+  std::string p = fold(q);
+  int n = ids.size();
+
+  // Find the range of keys starting with p.
+  auto less = [&](int e, const std::string& s) {
+    int c = std::memcmp(key(e), s.data(), std::min<int>(length(e), s.size()));
+    return c ? c < 0 : length(e) < (int)s.size();
+  };
+  int lo = 0, hi = n;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (less(mid, p))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  int begin = lo;
+  hi = n;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (length(mid) >= (int)p.size() &&
+        !std::memcmp(key(mid), p.data(), p.size()))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  int end = lo;
+  if (begin == end)
+    return out;
+
+  // Take the heaviest entries of the range, best first. The queue holds
+  // tree nodes that lie entirely inside the range.
+  int leaves = tree.size() / 2;
+  auto lighter = [&](int a, int b) {
+    return weights[tree[a]] < weights[tree[b]];
+  };
+  std::priority_queue<int, std::vector<int>, decltype(lighter)> heap(lighter);
+  for (int l = begin + leaves, r = end + leaves; l < r; l /= 2, r /= 2) {
+    if (l & 1)
+      heap.push(l++);
+    if (r & 1)
+      heap.push(--r);
+  }
+  while (!heap.empty() && (int)out.size() < k) {
+    int node = heap.top();
+    heap.pop();
+    if (node >= leaves) {
+      int e = tree[node];
+      if (!contains(out, ids[e]))
+        out.push_back({ids[e], 0, weights[e]});
+      continue;
+    }
+    for (int c = 2 * node; c <= 2 * node + 1; ++c)
+      if (tree[c] != -1)
+        heap.push(c);
+  }
+  return out;
+}
+
+std::vector<name_match>
+name_search::fuzzy(const std::string& q, int k, int edits) const {
+  std::vector<name_match> out;
+  std::string p = fold(q);
+  if (!ready() || k <= 0 || p.size() > 64)
+    return out;
+  int n = ids.size();
+  int m = p.size();
+
+  // A key within d edits misses at most 3d of the distinct trigrams of
+  // the query. Read every trigram that is no more common than the 3d + 1
+  // rarest one and keep the keys that appear in all but 3d of those lists.
+  // If the query has too few grams to filter on, every key is a candidate.
+  std::vector<std::uint32_t> g;
+  grams(p.data(), m, g);
+  std::sort(g.begin(), g.end());
+  g.erase(std::unique(g.begin(), g.end()), g.end());
+  std::vector<int> candidates;
+  if ((int)g.size() > 3 * edits) {
+    auto postings = [&](std::uint32_t b) {
+      return gram_first[b + 1] - gram_first[b];
+    };
+    std::sort(g.begin(), g.end(), [&](std::uint32_t a, std::uint32_t b) {
+      return postings(a) < postings(b);
+    });
+    std::uint32_t limit = postings(g[3 * edits]);
+    while (postings(g.back()) > limit)
+      g.pop_back();
+    int hits = g.size() - 3 * edits;
+
+    // Merge the sorted lists, counting how many each entry appears in.
+    typedef std::pair<std::uint32_t, std::uint32_t> cursor; // entry, list
+    std::priority_queue<cursor, std::vector<cursor>, std::greater<cursor>> heap;
+    std::vector<std::uint32_t> pos(g.size());
+    for (std::size_t i = 0; i < g.size(); ++i) {
+      pos[i] = gram_first[g[i]];
+      if (pos[i] != gram_first[g[i] + 1])
+        heap.push(cursor(gram_entry[pos[i]], i));
+    }
+    while (!heap.empty()) {
+      std::uint32_t e = heap.top().first;
+      int count = 0;
+      while (!heap.empty() && heap.top().first == e) {
+        std::uint32_t i = heap.top().second;
+        heap.pop();
+        ++count;
+        if (++pos[i] != gram_first[g[i] + 1])
+          heap.push(cursor(gram_entry[pos[i]], i));
+      }
+      if (count >= hits)
+        candidates.push_back(e);
+    }
+  } else {
+    candidates.resize(n);
+    std::iota(candidates.begin(), candidates.end(), 0);
+  }
+
+  myers dp(p);
+  for (int e : candidates) {
+    if (std::abs(length(e) - m) > edits)
+      continue;
+    int d = dp.distance(key(e), length(e));
+    if (d <= edits)
+      out.push_back({ids[e], d, weights[e]});
+  }
+
+  // Keep the best match for each id, then the best k.
+  std::sort(out.begin(), out.end(), better);
+  std::vector<name_match> best;
+  for (const name_match& x : out) {
+    if ((int)best.size() == k)
+      break;
+    if (!contains(best, x.id))
+      best.push_back(x);
+  }
+  return best;
+}
+
+std::vector<name_match>
+name_search::find(const std::string& q, int k) const {
+  std::vector<name_match> out = prefix(q, k);
+  int m = fold(q).size();
+  if ((int)out.size() >= k || m < 4)
+    return out;
+  int edits = m < 8 ? 1 : m < 16 ? 2 : 3;
+  for (const name_match& x : fuzzy(q, k, edits)) {
+    if ((int)out.size() == k)
+      break;
+    if (!contains(out, x.id))
+      out.push_back(x);
+  }
+  return out;
+}
+
+std::size_t
+name_search::bytes() const {
+  return text.capacity() +
+         sizeof(std::uint32_t) * (first.capacity() + gram_first.capacity() +
+                                  gram_entry.capacity()) +
+         sizeof(int) * (ids.capacity() + weights.capacity() + tree.capacity());
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_NAMES_HPP
+#define IMDB_NAMES_HPP
+
+#include "table.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// A candidate returned by a name search.
+struct name_match
+{
+  int id;       // Row in the searched table
+  int edits;    // Edit distance to the query; 0 for a prefix match
+  int weight;   // Number of roles, used to rank equally good matches
+};
+
+
+// Approximate search over the names of a table.
+//
+// Names are folded to lower case, stripped of quotes and of a trailing
+// "(I)" or "(1994)", and actors are indexed both as "Bacon, Kevin" and as
+// "Kevin Bacon". The folded keys are kept in one sorted array, so all the
+// names starting with a prefix are a contiguous range; a max tree over
+// that array yields the k most prolific names of a range in O(k log n).
+//
+// Typos are handled with a trigram index. A key within d edits of the
+// query shares all but at most 3d of its trigrams, so the common trigrams
+// of the query can be skipped and only keys found in nearly all of the
+// rare ones need to be checked.
+// Candidates are checked with Myers' bit-parallel edit distance, which
+// does one row of the dynamic program per machine word operation.
+struct name_search
+{
+  // Indexes the name of every row of t, weighted by its number of roles.
+  template<typename T>
+  void build(const table<T>& t);
+
+  // Returns the k heaviest names starting with the query.
+  std::vector<name_match> prefix(const std::string& q, int k) const;
+
+  // Returns the k best names within the given number of edits of the
+  // query, ordered by distance and then weight.
+  std::vector<name_match> fuzzy(const std::string& q, int k, int edits) const;
+
+  // Returns prefix matches followed by fuzzy matches, k in total. The
+  // number of edits allowed grows with the length of the query.
+  std::vector<name_match> find(const std::string& q, int k) const;
+
+  // Returns true if build has been called.
+  bool ready() const { return !first.empty(); }
+
+  int size() const { return ids.size(); }
+
+  // Returns the number of bytes used by the index.
+  std::size_t bytes() const;
+
+private:
+  void clear();
+  void add(const std::string& name, int id, int weight);
+  void finish();
+
+  const char* key(int e) const { return text.data() + first[e]; }
+  int length(int e) const { return first[e + 1] - first[e]; }
+
+  // Keys, sorted, stored back to back.
+  std::string text;
+  std::vector<std::uint32_t> first;
+  std::vector<int> ids;
+  std::vector<int> weights;
+
+  // Max tree over weights; tree[n + e] is entry e.
+  std::vector<int> tree;
+
+  // Trigram postings, bucketed by hash.
+  std::vector<std::uint32_t> gram_first;
+  std::vector<std::uint32_t> gram_entry;
+};
+
+
+template<typename T>
+void
+name_search::build(const table<T>& t) {
+  clear();
+  for (int i = 0; i < t.size(); ++i)
+    add(t[i].name, i, t[i].roles.size());
+  finish();
+}
+
+
+#endif
@@ -0,0 +1,146 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "pagerank.hpp"
+#include "db.hpp"
+#include "graph.hpp"
+#include "query.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+constexpr int block = 4096;
+
+// Sums x over the columns of one row, in four lanes.
+double
+gather(const int* col, int k, const double* x) {
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i = 0;
+  for (; i + 4 <= k; i += 4) {
+    s0 += x[col[i]];
+    s1 += x[col[i + 1]];
+    s2 += x[col[i + 2]];
+    s3 += x[col[i + 3]];
+  }
+  for (; i < k; ++i)
+    s0 += x[col[i]];
+  return (s0 + s1) + (s2 + s3);
+}
+
+// Divides each rank by its row's degree into y, and returns the rank of
+// rows without edges.
+double
+scale(const std::vector<int>& first, const std::vector<double>& x,
+      std::vector<double>& y, int lo, int hi) {
+  double dangling = 0;
+  for (int v = lo; v < hi; ++v) {
+    int deg = first[v + 1] - first[v];
+    y[v] = deg ? x[v] / deg : 0;
+    dangling += deg ? 0 : x[v];
+  }
+  return dangling;
+}
+
+} // namespace
+
+void
+pagerank::run(const database& db, int source, double tolerance,
+              int max_iterations, double damping, int threads) {
+  auto start = std::chrono::steady_clock::now();
+  frozen_graph g(db);
+  int n = g.actors();
+  int m = g.movies();
+  double uniform = 1.0 / std::max(1, n + m);
+
+  threads = thread_count(threads);
+
+  // The teleport vector.
+  auto actor_teleport = [&](int a) {
+    return source == -1 ? uniform : a == source ? 1.0 : 0.0;
+  };
+  auto movie_teleport = [&](int) {
+    return source == -1 ? uniform : 0.0;
+  };
+
+  actor_rank.assign(n, uniform);
+  movie_rank.assign(m, uniform);
+  std::vector<double> next_actor(n), next_movie(m);
+  std::vector<double> actor_share(n), movie_share(m);
+  std::vector<double> partial(threads);
+
+  iterations = 0;
+  residual = 0;
+  while (iterations < max_iterations) {
+    // Share out each vertex's rank over its edges.
+    std::fill(partial.begin(), partial.end(), 0);
+    parallel_blocks(n, block, threads, [&](int lo, int hi, int t) {
+      partial[t] += scale(g.actor_first, actor_rank, actor_share, lo, hi);
+    });
+    parallel_blocks(m, block, threads, [&](int lo, int hi, int t) {
+      partial[t] += scale(g.movie_first, movie_rank, movie_share, lo, hi);
+    });
+    double dangling = 0;
+    for (double d : partial)
+      dangling += d;
+    double teleport = (1 - damping) + damping * dangling;
+
+    // Gather the shares along the edges.
+    std::fill(partial.begin(), partial.end(), 0);
+    parallel_blocks(m, block, threads, [&](int lo, int hi, int t) {
+      double change = 0;
+      for (int f = lo; f < hi; ++f) {
+        int b = g.movie_first[f];
+        double r = teleport * movie_teleport(f) +
+                   damping * gather(&g.movie_actor[b], g.movie_first[f + 1] - b,
+                                    actor_share.data());
+        change += std::fabs(r - movie_rank[f]);
+        next_movie[f] = r;
+      }
+      partial[t] += change;
+    });
+    parallel_blocks(n, block, threads, [&](int lo, int hi, int t) {
+      double change = 0;
+      for (int a = lo; a < hi; ++a) {
+        int b = g.actor_first[a];
+        double r = teleport * actor_teleport(a) +
+                   damping * gather(&g.actor_movie[b], g.actor_first[a + 1] - b,
+                                    movie_share.data());
+        change += std::fabs(r - actor_rank[a]);
+        next_actor[a] = r;
+      }
+      partial[t] += change;
+    });
+    actor_rank.swap(next_actor);
+    movie_rank.swap(next_movie);
+    ++iterations;
+
+    residual = 0;
+    for (double d : partial)
+      residual += d;
+    if (progress)
+      *progress << "* pagerank: iteration " << iterations << ", change "
+                << residual << '\n';
+    if (residual < tolerance)
+      break;
+  }
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  seconds = dt.count();
+}
+
+std::vector<int>
+pagerank::top(int k) const {
+  std::vector<int> ids(actor_rank.size());
+  for (std::size_t i = 0; i < ids.size(); ++i)
+    ids[i] = i;
+  k = std::min<int>(k, ids.size());
+  std::partial_sort(ids.begin(), ids.begin() + k, ids.end(), [&](int a, int b) {
+    return actor_rank[a] > actor_rank[b];
+  });
+  ids.resize(k);
+  return ids;
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_PAGERANK_HPP
+#define IMDB_PAGERANK_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// PageRank over the bipartite actor-movie graph.
+//
+// A random walk steps from an actor to one of their roles' movies and from
+// a movie to one of its cast, so both halves of an iteration are sparse
+// matrix-vector products over the compressed adjacency of a frozen_graph:
+// movies gather from their cast, then actors from their movies. Rows are
+// handed out to threads in blocks of a few thousand, so each thread keeps
+// its slice of the output and offsets in cache, and each row is summed in
+// four independent lanes so the gathers are not serialized on one
+// accumulator. Rank held by actors or movies without edges is spread like
+// the teleport vector.
+//
+// With a source actor, every teleport returns to the source and the result
+// is personalized PageRank: the chance of ending a walk from the source at
+// each vertex.
+struct pagerank
+{
+  // Iterates until the L1 change in ranks falls below the tolerance, or
+  // for at most max_iterations. A source of -1 teleports uniformly. A
+  // thread count of 0 uses all available cores.
+  void run(const database& db, int source = -1, double tolerance = 1e-6,
+           int max_iterations = 100, double damping = 0.85, int threads = 0);
+
+  // Returns the ids of the k actors with the highest rank.
+  std::vector<int> top(int k) const;
+
+  std::vector<double> actor_rank;
+  std::vector<double> movie_rank;
+
+  int iterations = 0;
+  double residual = 0; // L1 change in the last iteration
+  double seconds = 0;
+
+  // If set, the residual of every iteration is reported here.
+  std::ostream* progress = nullptr;
+};
+
+
+#endif
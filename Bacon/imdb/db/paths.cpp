@@ -0,0 +1,188 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "paths.hpp"
+#include "db.hpp"
+
+#include <limits>
+
+namespace {
+
+std::uint64_t
+saturating_add(std::uint64_t a, std::uint64_t b) {
+  std::uint64_t c = a + b;
+  return c < a ? std::numeric_limits<std::uint64_t>::max() : c;
+}
+
+} // namespace
+
+void
+path_dag::build(const database& db, int c) {
+  int n = db.actors.size();
+  int m = db.movies.size();
+  center = c;
+  distance.assign(n, unreachable);
+  count.assign(n, 0);
+  std::vector<unsigned char> mdist(m, unreachable);
+  std::vector<std::uint64_t> mcount(m, 0);
+
+  // Assign distances in breadth-first order, remembering where each
+  // level starts.
+  std::vector<int> order;
+  std::vector<std::size_t> level = {0};
+  order.reserve(n);
+  order.push_back(c);
+  distance[c] = 0;
+  for (std::size_t head = 0; head < order.size(); ++head) {
+    int u = order[head];
+    if (distance[u] != distance[order[level.back()]])
+      level.push_back(head);
+    for (int x : db.actors[u].roles) {
+      int f = db.roles[x].movie;
+      if (mdist[f] != unreachable)
+        continue;
+      mdist[f] = distance[u];
+      for (int i : db.movies[f].roles) {
+        int w = db.roles[i].actor;
+        if (distance[w] == unreachable) {
+          distance[w] = byte_distance(distance[u] + 1);
+          order.push_back(w);
+        }
+      }
+    }
+  }
+  level.push_back(order.size());
+
+  // Count paths a level at a time: first the actors of a level pass
+  // their counts to the movies they lead into, then the next level sums
+  // the counts of its parent movies. Walking distinct movies keeps
+  // repeated roles from counting a path twice.
+  count[c] = 1;
+  for (std::size_t l = 0; l + 1 < level.size(); ++l) {
+    for (std::size_t j = level[l]; j < level[l + 1]; ++j) {
+      int u = order[j];
+      const int* fs = db.films.begin(u);
+      for (int k = 0; k < db.films.size(u); ++k) {
+        int f = fs[k];
+        if (mdist[f] == distance[u])
+          mcount[f] = saturating_add(mcount[f], count[u]);
+      }
+    }
+    if (l + 2 == level.size())
+      break;
+    for (std::size_t j = level[l + 1]; j < level[l + 2]; ++j) {
+      int w = order[j];
+      const int* fs = db.films.begin(w);
+      for (int k = 0; k < db.films.size(w); ++k) {
+        int f = fs[k];
+        if (mdist[f] + 1 == distance[w])
+          count[w] = saturating_add(count[w], mcount[f]);
+      }
+    }
+  }
+
+  // Lay out the DAG.
+  film_first.assign(n + 1, 0);
+  films.clear();
+  for (int a = 0; a < n; ++a) {
+    film_first[a] = films.size();
+    if (distance[a] == unreachable || a == c)
+      continue;
+    const int* fs = db.films.begin(a);
+    for (int k = 0; k < db.films.size(a); ++k) {
+      int f = fs[k];
+      if (mdist[f] + 1 == distance[a])
+        films.push_back(f);
+    }
+  }
+  film_first[n] = films.size();
+
+  // An actor with several roles in a movie is still one parent.
+  std::vector<int> seen(n, -1);
+  cast_first.assign(m + 1, 0);
+  cast.clear();
+  for (int f = 0; f < m; ++f) {
+    cast_first[f] = cast.size();
+    if (mdist[f] == unreachable)
+      continue;
+    for (int i : db.movies[f].roles) {
+      int u = db.roles[i].actor;
+      if (distance[u] == mdist[f] && seen[u] != f) {
+        seen[u] = f;
+        cast.push_back(u);
+      }
+    }
+  }
+  cast_first[m] = cast.size();
+}
+
+path_enumerator::path_enumerator(const path_dag& g, int target)
+  : g(g), target(target)
+{
+  // Actors past the longest distance a byte holds have no paths counted.
+  int d = g.distance[target];
+  if (d == unreachable || g.count[target] == 0) {
+    done = true;
+    return;
+  }
+  film_choice.assign(d, 0);
+  actor_choice.assign(d, 0);
+  steps.resize(d);
+}
+
+// Recomputes the steps from the given level on, following the current
+// choices.
+void
+path_enumerator::fill(int l) {
+  for (; l < int(steps.size()); ++l) {
+    int a = l ? steps[l - 1].actor : target;
+    int f = g.films_begin(a)[film_choice[l]];
+    steps[l].movie = f;
+    steps[l].actor = g.cast_begin(f)[actor_choice[l]];
+  }
+}
+
+// Stores the next path in p. Returns false when there are no more.
+//
+// The choices at each level act as an odometer whose deepest digit moves
+// fastest. Changing the choice at a level changes the actor reached, so
+// the deeper choices restart from zero.
+bool
+path_enumerator::next(std::vector<path_step>& p) {
+  if (done)
+    return false;
+  if (!started) {
+    started = true;
+    fill(0);
+    p = steps;
+    return true;
+  }
+  for (int l = steps.size() - 1; l >= 0; --l) {
+    int a = l ? steps[l - 1].actor : target;
+    int f = steps[l].movie;
+    if (++actor_choice[l] < g.cast_end(f) - g.cast_begin(f)) {
+      fill(l);
+      p = steps;
+      return true;
+    }
+    actor_choice[l] = 0;
+    if (++film_choice[l] < g.films_end(a) - g.films_begin(a)) {
+      fill(l);
+      p = steps;
+      return true;
+    }
+    film_choice[l] = 0;
+  }
+  done = true;
+  return false;
+}
+
+// Returns up to n more paths.
+std::vector<std::vector<path_step>>
+path_enumerator::page(int n) {
+  std::vector<std::vector<path_step>> result;
+  std::vector<path_step> p;
+  while (int(result.size()) < n && next(p))
+    result.push_back(p);
+  return result;
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_PATHS_HPP
+#define IMDB_PATHS_HPP
+
+#include "distance.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct database;
+
+
+// All shortest paths from a center actor, as a compact DAG.
+//
+// A path alternates between actors and the movies they share. A movie's
+// distance is the least distance of its cast; it leads on to the cast
+// members one step further out. The DAG stores, for each actor, the movies
+// one step closer to the center, and for each such movie the cast members
+// at its distance. Path counts are accumulated level by level and saturate
+// at 2^64 - 1.
+struct path_dag
+{
+  // Requires db.films to be built.
+  void build(const database& db, int center);
+
+  // Returns the number of shortest paths from the center to actor a.
+  std::uint64_t paths(int a) const { return count[a]; }
+
+  // Parent movies of actor a, and parent actors of movie m, as ranges.
+  const int* films_begin(int a) const { return films.data() + film_first[a]; }
+  const int* films_end(int a) const { return films.data() + film_first[a + 1]; }
+  const int* cast_begin(int m) const { return cast.data() + cast_first[m]; }
+  const int* cast_end(int m) const { return cast.data() + cast_first[m + 1]; }
+
+  int center = -1;
+  std::vector<unsigned char> distance;
+  std::vector<std::uint64_t> count;
+
+  std::vector<int> film_first; // Offsets into films, one per actor + 1
+  std::vector<int> films;
+  std::vector<int> cast_first; // Offsets into cast, one per movie + 1
+  std::vector<int> cast;
+};
+
+
+// One link of a path: a movie and the next actor toward the center.
+struct path_step
+{
+  int movie;
+  int actor;
+};
+
+// Enumerates the shortest paths from an actor to the center lazily, in a
+// fixed order, so that they can be paged through without materializing
+// the whole set. The DAG must outlive the enumerator.
+struct path_enumerator
+{
+  path_enumerator(const path_dag& g, int target);
+
+  bool next(std::vector<path_step>& p);
+  std::vector<std::vector<path_step>> page(int n);
+
+private:
+  void fill(int level);
+
+  const path_dag& g;
+  int target;
+  bool started = false;
+  bool done = false;
+  std::vector<int> film_choice;  // Per level, index into parent films
+  std::vector<int> actor_choice; // Per level, index into parent cast
+  std::vector<path_step> steps;
+};
+
+
+#endif
@@ -0,0 +1,136 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_PROTOCOL_HPP
+#define IMDB_PROTOCOL_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+// The query protocol spoken over the daemon's Unix domain socket.
+//
+// Every message is a frame: a 4-byte little-endian payload length followed
+// by the payload. A request payload is an opcode byte followed by its
+// arguments, each terminated by a NUL:
+//
+//    'L' name          look up an actor's id
+//    'B' name          the actor's distance from the center
+//    'P' name          the path from the actor to the center
+//    'D' name name     the distance and path between two actors
+//
+// A response payload is a status byte, '+' for success or '-' for an
+// error, followed by text. A client may send its next request before the
+// previous response arrives; responses come back in request order.
+namespace protocol {
+
+  enum opcode : char {
+    lookup = 'L',
+    bacon = 'B',
+    path = 'P',
+    between = 'D',
+  };
+
+  // Frames larger than this are rejected.
+  constexpr std::uint32_t max_frame = 1 << 20;
+
+  // Appends a frame holding the payload to out.
+  inline void
+  frame(const std::string& payload, std::string& out) {
+    std::uint32_t n = payload.size();
+    for (int i = 0; i < 4; ++i)
+      out += char((n >> (8 * i)) & 0xff);
+    out += payload;
+  }
+
+  // Reads the length of the frame starting at p.
+  inline std::uint32_t
+  frame_length(const char* p) {
+    std::uint32_t n = 0;
+    for (int i = 0; i < 4; ++i)
+      n |= std::uint32_t(static_cast<unsigned char>(p[i])) << (8 * i);
+    return n;
+  }
+
+  // Builds a request payload.
+  inline std::string
+  request(opcode op, const std::string& a, const std::string& b = "") {
+    std::string s(1, op);
+    s += a;
+    s += '\0';
+    if (op == between) {
+      s += b;
+      s += '\0';
+    }
+    return s;
+  }
+
+  // Blocking helpers for clients.
+
+  inline int
+  connect_unix(const char* path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+      return -1;
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  inline bool
+  write_all(int fd, const char* p, std::size_t n) {
+    while (n) {
+      ssize_t k = ::write(fd, p, n);
+      if (k <= 0)
+        return false;
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  inline bool
+  read_all(int fd, char* p, std::size_t n) {
+    while (n) {
+      ssize_t k = ::read(fd, p, n);
+      if (k <= 0)
+        return false;
+      p += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  inline bool
+  send(int fd, const std::string& payload) {
+    std::string out;
+    frame(payload, out);
+    return write_all(fd, out.data(), out.size());
+  }
+
+  inline bool
+  receive(int fd, std::string& payload) {
+    char len[4];
+    if (!read_all(fd, len, 4))
+      return false;
+    std::uint32_t n = frame_length(len);
+    if (n > max_frame)
+      return false;
+    payload.resize(n);
+    return read_all(fd, &payload[0], n);
+  }
+
+} // namespace protocol
+
+
+#endif
@@ -0,0 +1,161 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "query.hpp"
+#include "db.hpp"
+#include "metrics.hpp"
+
+#include <algorithm>
+
+frozen_graph::frozen_graph(const database& db)
+  : db(db)
+{
+  int n = db.actors.size();
+  actor_first.reserve(n + 1);
+  actor_movie.reserve(db.roles.size());
+  actor_role.reserve(db.roles.size());
+  for (int a = 0; a < n; ++a) {
+    actor_first.push_back(actor_movie.size());
+    for (int x : db.actors[a].roles) {
+      actor_movie.push_back(db.roles[x].movie);
+      actor_role.push_back(x);
+    }
+  }
+  actor_first.push_back(actor_movie.size());
+
+  int m = db.movies.size();
+  movie_first.reserve(m + 1);
+  movie_actor.reserve(db.roles.size());
+  for (int f = 0; f < m; ++f) {
+    movie_first.push_back(movie_actor.size());
+    for (int x : db.movies[f].roles)
+      movie_actor.push_back(db.roles[x].actor);
+  }
+  movie_first.push_back(movie_actor.size());
+}
+
+query_context::query_context(const frozen_graph& g)
+  : g(g)
+{
+  for (int s = 0; s < 2; ++s) {
+    actor_stamp[s].assign(g.actors(), 0);
+    movie_stamp[s].assign(g.movies(), 0);
+    dist[s].resize(g.actors());
+    parent[s].resize(g.actors());
+  }
+}
+
+// Returns the id of the named actor, or -1.
+int
+query_context::lookup(const std::string& name) const {
+  IMDB_TIME(lookup);
+  return g.db.actor_lookup.find(name);
+}
+
+// Starts a new query. Stamps are only cleared when the epoch wraps.
+void
+query_context::next_epoch() {
+  if (++epoch == 0) {
+    for (int s = 0; s < 2; ++s) {
+      std::fill(actor_stamp[s].begin(), actor_stamp[s].end(), 0);
+      std::fill(movie_stamp[s].begin(), movie_stamp[s].end(), 0);
+    }
+    epoch = 1;
+  }
+}
+
+// Runs a bidirectional search between a and b, returning their distance
+// or -1. Each round expands a full level of the smaller frontier, and the
+// best meeting found on that level is recorded for path reconstruction.
+int
+query_context::search(int a, int b) {
+  IMDB_TIME(meet);
+  next_epoch();
+  int src[2] = {a, b};
+  for (int s = 0; s < 2; ++s) {
+    actor_stamp[s][src[s]] = epoch;
+    dist[s][src[s]] = 0;
+    parent[s][src[s]] = -1;
+    frontier[s].assign(1, src[s]);
+  }
+  if (a == b)
+    return 0;
+
+  while (!frontier[0].empty() && !frontier[1].empty()) {
+    int s = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+    int o = 1 - s;
+    int best = -1;
+    next.clear();
+    for (int u : frontier[s]) {
+      for (int i = g.actor_first[u]; i < g.actor_first[u + 1]; ++i) {
+        int f = g.actor_movie[i];
+        if (movie_stamp[s][f] == epoch)
+          continue;
+        movie_stamp[s][f] = epoch;
+        for (int j = g.movie_first[f]; j < g.movie_first[f + 1]; ++j) {
+          int w = g.movie_actor[j];
+          if (actor_stamp[o][w] == epoch) {
+            int d = dist[s][u] + 1 + dist[o][w];
+            if (best == -1 || d < best) {
+              best = d;
+              meet_from = u;
+              meet_to = w;
+              meet_role = i;
+              meet_side = s;
+            }
+          }
+          if (actor_stamp[s][w] != epoch) {
+            actor_stamp[s][w] = epoch;
+            dist[s][w] = dist[s][u] + 1;
+            parent[s][w] = g.actor_role[i];
+            next.push_back(w);
+          }
+        }
+      }
+    }
+    if (best != -1)
+      return best;
+    frontier[s].swap(next);
+  }
+  return -1;
+}
+
+int
+query_context::distance(int a, int b) {
+  return search(a, b);
+}
+
+// Stores a shortest path from a to b in steps, each naming a movie and the
+// next actor along the path, and returns its length, or -1 if there is no
+// path.
+int
+query_context::path(int a, int b, std::vector<path_step>& steps) {
+  steps.clear();
+  int d = search(a, b);
+  if (d <= 0)
+    return d;
+  IMDB_TIME(path);
+
+  const database& db = g.db;
+  // Links from the side-0 source out to the meeting, and from the meeting
+  // on to the side-1 source. parent[s][w] is the role, in the shared movie,
+  // of the actor one step closer to side s's source.
+  int x = meet_side == 0 ? meet_from : meet_to;
+  int y = meet_side == 0 ? meet_to : meet_from;
+  int film = g.actor_movie[meet_role];
+
+  std::vector<path_step> head;
+  for (int w = x; w != a; ) {
+    const role& r = db.roles[parent[0][w]];
+    head.push_back({r.movie, w});
+    w = r.actor;
+  }
+  steps.assign(head.rbegin(), head.rend());
+  steps.push_back({film, y});
+  for (int w = y; w != b; ) {
+    const role& r = db.roles[parent[1][w]];
+    steps.push_back({r.movie, r.actor});
+    w = r.actor;
+  }
+  return d;
+}
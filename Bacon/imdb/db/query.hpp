@@ -0,0 +1,76 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_QUERY_HPP
+#define IMDB_QUERY_HPP
+
+#include "paths.hpp"
+
+#include <string>
+#include <vector>
+
+struct database;
+
+
+// An immutable snapshot of the actor-movie graph for concurrent queries.
+//
+// The adjacency is copied out of the tables into compressed arrays: for
+// each actor its movies (and the roles linking them), and for each movie
+// its cast. Nothing here changes after construction, so any number of
+// threads may read it at once. Names are resolved through the database's
+// lookup tables, which are also only read. The database must not be
+// modified while a snapshot of it is in use.
+struct frozen_graph
+{
+  explicit frozen_graph(const database& db);
+
+  int actors() const { return actor_first.size() - 1; }
+  int movies() const { return movie_first.size() - 1; }
+
+  const database& db;
+
+  std::vector<int> actor_first; // Offsets into the next two, per actor + 1
+  std::vector<int> actor_movie;
+  std::vector<int> actor_role;
+  std::vector<int> movie_first; // Offsets into movie_actor, per movie + 1
+  std::vector<int> movie_actor;
+};
+
+
+// Scratch state for queries issued by one thread.
+//
+// A context owns the marks and distances used by its searches. Instead of
+// clearing them before each query, every entry is stamped with the epoch
+// that wrote it, and starting a query just advances the epoch; entries with
+// an older stamp read as unvisited. Contexts are cheap to keep per thread
+// and must not be shared between threads.
+struct query_context
+{
+  explicit query_context(const frozen_graph& g);
+
+  int lookup(const std::string& name) const;
+  int distance(int a, int b);
+  int path(int a, int b, std::vector<path_step>& steps);
+
+  const frozen_graph& g;
+
+private:
+  int search(int a, int b);
+  void next_epoch();
+
+  unsigned epoch = 0;
+  std::vector<unsigned> actor_stamp[2];
+  std::vector<unsigned> movie_stamp[2];
+  std::vector<int> dist[2];   // Valid where stamped
+  std::vector<int> parent[2]; // Role toward the side's source
+  std::vector<int> frontier[2];
+  std::vector<int> next;
+
+  int meet_from; // Actor on the expanding side of the best meeting
+  int meet_to;   // Actor on the other side
+  int meet_role; // Index into meet_from's adjacency of the movie they share
+  int meet_side; // Side that found the meeting
+};
+
+
+#endif
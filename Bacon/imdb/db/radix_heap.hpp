@@ -0,0 +1,78 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_RADIX_HEAP_HPP
+#define IMDB_RADIX_HEAP_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// A monotone priority queue for unsigned 32-bit keys.
+//
+// Keys may never be less than the last key popped, which is the case for
+// Dijkstra's algorithm with non-negative weights. An entry is kept in the
+// bucket numbered by the highest bit in which its key differs from the
+// last popped key. Popping from an empty bucket 0 redistributes the first
+// non-empty bucket around its minimum, and every entry moves to a lower
+// bucket each time it is redistributed, so operations are amortized
+// O(log C) for a maximum key difference of C, with no comparisons between
+// entries on push.
+template<typename T>
+class radix_heap
+{
+public:
+  using key_type = std::uint32_t;
+
+  bool empty() const { return count == 0; }
+  int size() const { return count; }
+
+  void push(key_type k, const T& v) {
+    assert(k >= last);
+    buckets[index(k)].emplace_back(k, v);
+    ++count;
+  }
+
+  // Removes an entry with the least key.
+  std::pair<key_type, T> pop() {
+    assert(!empty());
+    if (buckets[0].empty()) {
+      int i = 1;
+      while (buckets[i].empty())
+        ++i;
+      key_type least = buckets[i][0].first;
+      for (auto& e : buckets[i])
+        if (e.first < least)
+          least = e.first;
+      last = least;
+      for (auto& e : buckets[i])
+        buckets[index(e.first)].push_back(e);
+      buckets[i].clear();
+    }
+    std::pair<key_type, T> e = buckets[0].back();
+    buckets[0].pop_back();
+    --count;
+    return e;
+  }
+
+  void clear() {
+    for (auto& b : buckets)
+      b.clear();
+    last = 0;
+    count = 0;
+  }
+
+private:
+  int index(key_type k) const {
+    return k == last ? 0 : 32 - __builtin_clz(k ^ last);
+  }
+
+  std::vector<std::pair<key_type, T>> buckets[33];
+  key_type last = 0;
+  int count = 0;
+};
+
+
+#endif
@@ -0,0 +1,203 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "reorder.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+// Vertices of the bipartite graph are numbered with actors first and
+// movies after them.
+struct bipartite
+{
+  bipartite(const database& db)
+    : db(db), actors(db.actors.size()), movies(db.movies.size())
+  { }
+
+  int size() const { return actors + movies; }
+
+  int degree(int v) const {
+    if (v < actors)
+      return db.actors[v].roles.size();
+    return db.movies[v - actors].roles.size();
+  }
+
+  template<typename F>
+  void neighbors(int v, F f) const {
+    if (v < actors) {
+      for (int x : db.actors[v].roles)
+        f(actors + db.roles[x].movie);
+    } else {
+      for (int x : db.movies[v - actors].roles)
+        f(db.roles[x].actor);
+    }
+  }
+
+  const database& db;
+  int actors;
+  int movies;
+};
+
+// Returns all vertices sorted by decreasing degree.
+std::vector<int>
+by_degree(const bipartite& g) {
+  std::vector<int> seq(g.size());
+  std::iota(seq.begin(), seq.end(), 0);
+  std::stable_sort(seq.begin(), seq.end(), [&](int a, int b) {
+    return g.degree(a) > g.degree(b);
+  });
+  return seq;
+}
+
+// Returns all vertices in breadth-first order. Each component is entered
+// from the first unvisited vertex in the given sequence of roots. When
+// sorted is set, the neighbors of each vertex are visited in increasing
+// order of degree, as Cuthill-McKee requires.
+std::vector<int>
+by_search(const bipartite& g, const std::vector<int>& roots, bool sorted) {
+  std::vector<int> seq;
+  seq.reserve(g.size());
+  std::vector<bool> seen(g.size(), false);
+  std::vector<int> adj;
+  for (int root : roots) {
+    if (seen[root])
+      continue;
+    seen[root] = true;
+    seq.push_back(root);
+    for (std::size_t head = seq.size() - 1; head < seq.size(); ++head) {
+      int v = seq[head];
+      adj.clear();
+      g.neighbors(v, [&](int w) {
+        if (!seen[w]) {
+          seen[w] = true;
+          adj.push_back(w);
+        }
+      });
+      if (sorted)
+        std::stable_sort(adj.begin(), adj.end(), [&](int a, int b) {
+          return g.degree(a) < g.degree(b);
+        });
+      seq.insert(seq.end(), adj.begin(), adj.end());
+    }
+  }
+  return seq;
+}
+
+// Times uncached searches from the given centers.
+double
+time_searches(database& db, const std::vector<int>& centers) {
+  auto start = std::chrono::steady_clock::now();
+  for (int c : centers)
+    db.explore(c);
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  return dt.count() / std::max<std::size_t>(1, centers.size());
+}
+
+// Moves each row of t to its new position.
+template<typename T>
+void
+permute(table<T>& t, const std::vector<int>& perm) {
+  // Keep the reserved capacity: short names live inside the rows, and the
+  // lookup indexes would dangle if a later append reallocated them.
+  std::vector<T> rows;
+  rows.reserve(t.rows.capacity());
+  rows.resize(t.size());
+  for (int i = 0; i < t.size(); ++i)
+    rows[perm[i]] = std::move(t[i]);
+  t.rows.swap(rows);
+}
+
+} // namespace
+
+reorder_stats
+reorder(database& db, vertex_order k) {
+  reorder_stats stats;
+  bipartite g(db);
+
+  // Measure searches from the highest-degree actors.
+  std::vector<int> centers;
+  std::vector<int> rank = by_degree(g);
+  for (int v : rank) {
+    if (v < g.actors)
+      centers.push_back(v);
+    if (centers.size() == 4)
+      break;
+  }
+  stats.before = time_searches(db, centers);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<int> seq;
+  switch (k) {
+  case vertex_order::degree:
+    seq = rank;
+    break;
+  case vertex_order::bfs:
+    seq = by_search(g, rank, false);
+    break;
+  case vertex_order::rcm: {
+    // Start each component from a low-degree vertex, then reverse.
+    std::vector<int> roots(rank.rbegin(), rank.rend());
+    seq = by_search(g, roots, true);
+    std::reverse(seq.begin(), seq.end());
+    break;
+  }
+  }
+
+  // Split the combined sequence into actor and movie numberings.
+  std::vector<int> actor_perm(g.actors), movie_perm(g.movies);
+  int na = 0, nm = 0;
+  for (int v : seq) {
+    if (v < g.actors)
+      actor_perm[v] = na++;
+    else
+      movie_perm[v - g.actors] = nm++;
+  }
+
+  permute(db.actors, actor_perm);
+  permute(db.movies, movie_perm);
+  ++db.generation;
+  for (role& r : db.roles.rows) {
+    r.actor = actor_perm[r.actor];
+    r.movie = movie_perm[r.movie];
+  }
+
+  // The indexes hold pointers into the names, which have moved.
+  db.actor_lookup.map.clear();
+  for (int i = 0; i < db.actors.size(); ++i)
+    db.actor_lookup.emplace(db.actors[i].name.c_str(), i);
+  db.movie_lookup.map.clear();
+  for (int i = 0; i < db.movies.size(); ++i)
+    db.movie_lookup.emplace(db.movies[i].name.c_str(), i);
+  if (db.actor_names.ready()) {
+    db.actor_names.build(db.actors);
+    db.movie_names.build(db.movies);
+  }
+
+  db.cache.clear();
+  if (db.films.ready())
+    db.films.build(db);
+  if (db.parts.ready())
+    db.parts.run(db);
+  if (db.center != -1)
+    db.BaconNumber(actor_perm[db.center]);
+
+  std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+  stats.seconds = dt.count();
+
+  for (int& c : centers)
+    c = actor_perm[c];
+  stats.after = time_searches(db, centers);
+  return stats;
+}
+
+void
+report(const reorder_stats& s, std::ostream& os) {
+  os << "* reordered in " << s.seconds << " s; search "
+     << s.before * 1e3 << " ms -> " << s.after * 1e3 << " ms ("
+     << s.before / s.after << "x)\n";
+}
@@ -0,0 +1,44 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_REORDER_HPP
+#define IMDB_REORDER_HPP
+
+#include <iosfwd>
+#include <vector>
+
+struct database;
+
+
+// Renumbering of actors and movies for cache locality.
+//
+// Ids are assigned in file order, which is alphabetical, so the co-stars
+// of an actor are scattered across the tables and nearly every neighbor
+// visited by a search is a cache miss. Reordering assigns new ids so that
+// vertices visited close together in time are stored close together.
+enum class vertex_order
+{
+  degree, // Most roles first
+  bfs,    // Breadth-first discovery order
+  rcm,    // Reverse Cuthill-McKee
+};
+
+// Describes the effect of a reordering pass.
+struct reorder_stats
+{
+  double seconds = 0; // Time spent computing and applying the order
+  double before = 0;  // Seconds per search before reordering
+  double after = 0;   // Seconds per search after reordering
+};
+
+// Renumbers the actors and movies of db. Name lookups and components are
+// rebuilt, cached searches are dropped, and the current center's distances
+// and paths are recomputed. The search speedup is measured on a few
+// high-degree centers.
+reorder_stats reorder(database& db, vertex_order k);
+
+// Prints the time taken and the change in search time.
+void report(const reorder_stats& s, std::ostream& os);
+
+
+#endif
@@ -2,3 +2,14 @@
 // All rights reserved
 
 #include "roles.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+int
+parse_billing(const char* info) {
+  const char* p = std::strrchr(info, '<');
+  if (!p)
+    return 0;
+  return std::atoi(p + 1);
+}
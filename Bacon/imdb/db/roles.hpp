@@ -7,17 +7,23 @@
 #include "table.hpp"
 
 
+// Returns the billing position in a role description, given as <n> at
+// its end, or 0 if the role is not billed.
+int parse_billing(const char* info);
+
+
 // Represents an actor's role in a movie or production.
 //
-// TODO: Factor the role description into useful information.
+// TODO: Factor the rest of the role description into useful information.
 struct role
 {
   role(int a, int m, const char* i)
-    : actor(a), movie(m), info(i)
+    : actor(a), movie(m), billing(parse_billing(i)), info(i)
   { }
 
   int actor;
   int movie;
+  int billing;
   std::string info;
 };
 
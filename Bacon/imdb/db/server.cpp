@@ -0,0 +1,382 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "server.hpp"
+#include "db.hpp"
+#include "metrics.hpp"
+#include "protocol.hpp"
+#include "query.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+
+namespace {
+
+// A request or a response, tagged with the connection it belongs to. The
+// serial number tells a reused descriptor apart from a closed connection.
+struct message
+{
+  int fd;
+  unsigned long serial;
+  std::string payload;
+};
+
+// A connection stops being read once this much input is buffered, which
+// still leaves room for one frame of the largest size.
+constexpr std::size_t max_input = 2 * (4 + std::size_t(protocol::max_frame));
+
+struct connection
+{
+  unsigned long serial;
+  std::string in;
+  std::string out;
+  bool busy = false; // A request is with the workers
+};
+
+// Requests waiting for a worker, and responses waiting for the loop.
+struct exchange
+{
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<message> jobs;
+  std::deque<message> done;
+  bool stop = false;
+  int wake; // eventfd signaled when a response is posted
+};
+
+// Walks the compact search result from a back to the center.
+void
+append_path(const database& db, const bfs_result& r, int a, std::string& s) {
+  IMDB_TIME(path);
+  while (a != r.center) {
+    const role& link = db.roles[r.parent[a]];
+    s += " / ";
+    s += db.movies[link.movie].name;
+    s += " / ";
+    s += db.actors[link.actor].name;
+    a = link.actor;
+  }
+}
+
+std::string
+answer(query_context& q, const bfs_result& r, const std::string& req) {
+  IMDB_TIME(request);
+  const database& db = q.g.db;
+  if (req.empty())
+    return "-empty request";
+
+  // Split the NUL-terminated arguments.
+  std::vector<std::string> args;
+  std::size_t p = 1;
+  while (p < req.size()) {
+    std::size_t e = req.find('\0', p);
+    if (e == std::string::npos)
+      e = req.size();
+    args.push_back(req.substr(p, e - p));
+    p = e + 1;
+  }
+  std::size_t want = req[0] == protocol::between ? 2 : 1;
+  if (args.size() != want)
+    return "-wrong number of arguments";
+
+  std::vector<int> ids;
+  for (const std::string& name : args) {
+    int a = q.lookup(name);
+    if (a == -1)
+      return "-no actor named '" + name + "'";
+    ids.push_back(a);
+  }
+
+  int a = ids[0];
+  switch (req[0]) {
+  case protocol::lookup:
+    return "+" + std::to_string(a);
+
+  case protocol::bacon:
+  case protocol::path: {
+    if (r.distance[a] == unreachable)
+      return "-no connection";
+    std::string s = "+" + std::to_string(r.distance[a]);
+    if (req[0] == protocol::path) {
+      s += '\t';
+      s += db.actors[a].name;
+      append_path(db, r, a, s);
+    }
+    return s;
+  }
+
+  case protocol::between: {
+    std::vector<path_step> steps;
+    int d = q.path(a, ids[1], steps);
+    if (d < 0)
+      return "-no connection";
+    std::string s = "+" + std::to_string(d) + '\t' + db.actors[a].name;
+    for (const path_step& st : steps) {
+      s += " / ";
+      s += db.movies[st.movie].name;
+      s += " / ";
+      s += db.actors[st.actor].name;
+    }
+    return s;
+  }
+
+  default:
+    return "-unknown opcode";
+  }
+}
+
+void
+work(exchange& x, const frozen_graph& g, const bfs_result& r) {
+  query_context q(g);
+  while (true) {
+    message msg;
+    {
+      std::unique_lock<std::mutex> lock(x.m);
+      x.cv.wait(lock, [&] { return x.stop || !x.jobs.empty(); });
+      if (x.stop)
+        return;
+      msg = std::move(x.jobs.front());
+      x.jobs.pop_front();
+    }
+    msg.payload = answer(q, r, msg.payload);
+    {
+      std::lock_guard<std::mutex> lock(x.m);
+      x.done.push_back(std::move(msg));
+    }
+    std::uint64_t one = 1;
+    ssize_t k = ::write(x.wake, &one, sizeof(one));
+    (void)k;
+  }
+}
+
+void
+watch(int ep, int fd, unsigned events) {
+  epoll_event ev = {};
+  ev.events = events;
+  ev.data.fd = fd;
+  ::epoll_ctl(ep, EPOLL_CTL_MOD, fd, &ev);
+}
+
+// Returns the events to wait for on a connection: input while its buffer
+// has room, and output while some is pending.
+unsigned
+interest(const connection& c) {
+  return (c.in.size() < max_input ? EPOLLIN : 0) |
+         (c.out.empty() ? 0 : EPOLLOUT);
+}
+
+} // namespace
+
+int
+serve(database& db, int center, const char* path, int threads) {
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // Handle termination signals in the loop rather than asynchronously.
+  // Blocking them first means the workers inherit the mask.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  sigaddset(&signals, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  int lfd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+  // Replace a socket left behind by an earlier server, but nothing else.
+  struct stat st;
+  if (::lstat(path, &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      std::cerr << "error: " << path << " exists and is not a socket\n";
+      if (lfd >= 0)
+        ::close(lfd);
+      return 1;
+    }
+    ::unlink(path);
+  }
+  if (lfd < 0 || ::bind(lfd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+      ::listen(lfd, 128) < 0) {
+    std::perror("error: cannot listen");
+    return 1;
+  }
+
+  frozen_graph g(db);
+  bfs_ptr r = db.search(center);
+
+  exchange x;
+  x.wake = ::eventfd(0, EFD_NONBLOCK);
+  sigdelset(&signals, SIGPIPE);
+  int sfd = ::signalfd(-1, &signals, SFD_NONBLOCK);
+  int ep = ::epoll_create1(0);
+  if (x.wake < 0 || sfd < 0 || ep < 0) {
+    std::perror("error: cannot set up the event loop");
+    for (int fd : {x.wake, sfd, ep, lfd})
+      if (fd >= 0)
+        ::close(fd);
+    ::unlink(path);
+    return 1;
+  }
+  for (int fd : {lfd, x.wake, sfd}) {
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    ::epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+  }
+
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t)
+    pool.emplace_back(work, std::ref(x), std::cref(g), std::cref(*r));
+
+  std::unordered_map<int, connection> conns;
+  unsigned long serial = 0;
+  long served = 0;
+
+  auto close_conn = [&](int fd) {
+    ::epoll_ctl(ep, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    conns.erase(fd);
+  };
+
+  // Sends as much buffered output as the socket takes, and asks for a
+  // writable event if some is left over.
+  auto flush = [&](int fd, connection& c) {
+    while (!c.out.empty()) {
+      ssize_t k = ::write(fd, c.out.data(), c.out.size());
+      if (k < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+          break;
+        return false;
+      }
+      c.out.erase(0, k);
+      IMDB_COUNT(bytes_written, k);
+    }
+    watch(ep, fd, interest(c));
+    return true;
+  };
+
+  // Hands the next complete frame to the workers, if the connection is
+  // idle. Returns false if the frame is malformed.
+  auto dispatch = [&](int fd, connection& c) {
+    if (c.busy || c.in.size() < 4)
+      return true;
+    std::uint32_t n = protocol::frame_length(c.in.data());
+    if (n > protocol::max_frame)
+      return false;
+    if (c.in.size() < 4 + n)
+      return true;
+    message msg{fd, c.serial, c.in.substr(4, n)};
+    c.in.erase(0, 4 + n);
+    c.busy = true;
+    std::lock_guard<std::mutex> lock(x.m);
+    x.jobs.push_back(std::move(msg));
+    x.cv.notify_one();
+    return true;
+  };
+
+  std::cout << "* serving on " << path << " with " << threads
+            << " workers" << std::endl;
+
+  bool running = true;
+  std::vector<epoll_event> events(256);
+  while (running) {
+    int n = ::epoll_wait(ep, events.data(), events.size(), -1);
+    if (n < 0 && errno != EINTR)
+      break;
+    for (int i = 0; i < n; ++i) {
+      int fd = events[i].data.fd;
+      if (fd == sfd) {
+        running = false;
+      } else if (fd == lfd) {
+        int cfd;
+        while ((cfd = ::accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK)) >= 0) {
+          connection& c = conns[cfd];
+          c.serial = ++serial;
+          epoll_event ev = {};
+          ev.events = EPOLLIN;
+          ev.data.fd = cfd;
+          ::epoll_ctl(ep, EPOLL_CTL_ADD, cfd, &ev);
+        }
+      } else if (fd == x.wake) {
+        std::uint64_t count;
+        ssize_t k = ::read(x.wake, &count, sizeof(count));
+        (void)k;
+        std::deque<message> done;
+        {
+          std::lock_guard<std::mutex> lock(x.m);
+          done.swap(x.done);
+        }
+        for (message& msg : done) {
+          auto iter = conns.find(msg.fd);
+          if (iter == conns.end() || iter->second.serial != msg.serial)
+            continue;
+          connection& c = iter->second;
+          ++served;
+          protocol::frame(msg.payload, c.out);
+          c.busy = false;
+          if (!dispatch(msg.fd, c) || !flush(msg.fd, c))
+            close_conn(msg.fd);
+        }
+      } else {
+        auto iter = conns.find(fd);
+        if (iter == conns.end())
+          continue;
+        connection& c = iter->second;
+        bool ok = true;
+        if (events[i].events & EPOLLIN) {
+          // Stop reading at the cap; the rest waits in the socket until
+          // the workers have drained some requests.
+          char buf[16384];
+          while (c.in.size() < max_input) {
+            ssize_t k = ::read(fd, buf, sizeof(buf));
+            if (k > 0) {
+              c.in.append(buf, k);
+              continue;
+            }
+            if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+              break;
+            ok = false;
+            break;
+          }
+          ok = ok && dispatch(fd, c);
+          if (ok && c.in.size() >= max_input)
+            watch(ep, fd, interest(c));
+        }
+        if (ok && (events[i].events & EPOLLOUT))
+          ok = flush(fd, c);
+        if (!ok || (events[i].events & (EPOLLERR | EPOLLHUP)))
+          close_conn(fd);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(x.m);
+    x.stop = true;
+  }
+  x.cv.notify_all();
+  for (std::thread& t : pool)
+    t.join();
+  for (auto& c : conns)
+    ::close(c.first);
+  ::close(lfd);
+  ::unlink(path);
+  std::cout << "* served " << served << " requests" << std::endl;
+  return 0;
+}
@@ -0,0 +1,25 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_SERVER_HPP
+#define IMDB_SERVER_HPP
+
+struct database;
+
+
+// Serves queries against the loaded database on a Unix domain socket,
+// using the frame protocol in protocol.hpp, until SIGINT or SIGTERM.
+//
+// A single thread runs an epoll loop over non-blocking sockets: it accepts
+// connections, buffers their input, and cuts it into frames. Each complete
+// request is handed to a pool of worker threads, which answer it against a
+// frozen snapshot of the graph with their own query contexts, and post the
+// response back to the loop through an eventfd. A connection has at most
+// one request in flight, so its responses keep request order. Distances
+// and paths from the center come from one search run before serving.
+//
+// Returns 0 on a clean shutdown, or 1 if the socket cannot be opened.
+int serve(database& db, int center, const char* path, int threads = 0);
+
+
+#endif
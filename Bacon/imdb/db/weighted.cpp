@@ -0,0 +1,85 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#include "weighted.hpp"
+#include "db.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+constexpr unsigned weighted_paths::unreachable;
+
+unsigned
+billing_weight(const role& r, const movie&) {
+  if (r.billing >= 1 && r.billing <= 3)
+    return 1;
+  if (r.billing >= 4 && r.billing <= 10)
+    return 2;
+  return 3;
+}
+
+edge_weight
+year_weight(int year) {
+  return [year](const role&, const movie& m) -> unsigned {
+    if (!m.year)
+      return 10;
+    return std::min(10, 1 + std::abs(m.year - year) / 5);
+  };
+}
+
+void
+weighted_paths::weigh(const database& db, const edge_weight& w) {
+  weight.resize(db.roles.size());
+  for (int r = 0; r < db.roles.size(); ++r)
+    weight[r] = w(db.roles[r], db.movies[db.roles[r].movie]);
+  center = -1;
+}
+
+bool
+weighted_paths::run(const database& db, int c) {
+  if (weight.size() != std::size_t(db.roles.size()))
+    return false;
+  int n = db.actors.size();
+  center = c;
+  cost.assign(n + db.movies.size(), unreachable);
+  parent.assign(cost.size(), -1);
+
+  heap.clear();
+  cost[c] = 0;
+  heap.push(0, c);
+  while (!heap.empty()) {
+    auto e = heap.pop();
+    int v = e.second;
+    if (e.first != cost[v])
+      continue;
+    const std::vector<int>& edges =
+      v < n ? db.actors[v].roles : db.movies[v - n].roles;
+    for (int r : edges) {
+      int w = v < n ? n + db.roles[r].movie : db.roles[r].actor;
+      unsigned d = e.first + weight[r];
+      if (d < cost[w]) {
+        cost[w] = d;
+        parent[w] = r;
+        heap.push(d, w);
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<int>
+weighted_paths::path(const database& db, int a) const {
+  std::vector<int> result;
+  if (cost[a] == unreachable)
+    return result;
+  int n = db.actors.size();
+  while (a != center) {
+    int r = parent[a];
+    int m = n + db.roles[r].movie;
+    int p = parent[m];
+    result.push_back(r);
+    result.push_back(p);
+    a = db.roles[p].actor;
+  }
+  return result;
+}
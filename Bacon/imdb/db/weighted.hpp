@@ -0,0 +1,66 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_WEIGHTED_HPP
+#define IMDB_WEIGHTED_HPP
+
+#include "radix_heap.hpp"
+
+#include <functional>
+#include <vector>
+
+struct database;
+struct role;
+struct movie;
+
+
+// The weight of the link between an actor and a movie, given the role that
+// forms it. Weights must be non-negative; small integers work best.
+using edge_weight = std::function<unsigned(const role&, const movie&)>;
+
+// Lead roles make stronger links: billing 1-3 weighs 1, billing 4-10
+// weighs 2, and anything else weighs 3.
+unsigned billing_weight(const role& r, const movie& m);
+
+// Movies released close to the given year make stronger links. The weight
+// grows by one for every five years away, up to 10, which is also the
+// weight of movies with an unknown year.
+edge_weight year_weight(int year);
+
+
+// Cheapest paths from a center actor over the weighted actor-movie graph.
+//
+// The weight function is applied once per role, when the weights are set,
+// and the costs are then computed with Dijkstra's algorithm on a radix
+// heap. Vertices are numbered with actors first and movies after them; the
+// cost of reaching an actor through a movie is the weight of the role that
+// enters the movie plus the weight of the role that leaves it.
+struct weighted_paths
+{
+  static constexpr unsigned unreachable = unsigned(-1);
+
+  void weigh(const database& db, const edge_weight& w);
+
+  // Computes costs from the center. Returns false, without searching, if
+  // the weights do not cover every role.
+  bool run(const database& db, int center);
+
+  // Returns the cost of the cheapest path to actor a.
+  unsigned cost_of(int a) const { return cost[a]; }
+
+  // Returns the roles along the cheapest path from actor a to the center.
+  // Each pair of roles is one link: a's role in a movie, then the role of
+  // the next actor in the same movie.
+  std::vector<int> path(const database& db, int a) const;
+
+  int center = -1;
+  std::vector<unsigned> weight; // Per role
+  std::vector<unsigned> cost;   // Per vertex
+  std::vector<int> parent;      // Role through which each vertex is reached
+
+private:
+  radix_heap<int> heap;
+};
+
+
+#endif
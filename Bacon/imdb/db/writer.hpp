@@ -0,0 +1,49 @@
+// Copyright (c) 2016 Andrew Sutton
+// All rights reserved
+
+#ifndef IMDB_WRITER_HPP
+#define IMDB_WRITER_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+// A large output buffer in front of a C file. Small writes are collected
+// and handed to the file in big sequential blocks.
+struct buffered_writer
+{
+  explicit buffered_writer(std::FILE* f, std::size_t cap = 4 << 20)
+    : file(f), buf(cap)
+  { }
+
+  ~buffered_writer() { flush(); }
+
+  void write(const char* s, std::size_t n) {
+    if (used + n > buf.size()) {
+      flush();
+      if (n > buf.size()) {
+        std::fwrite(s, 1, n, file);
+        return;
+      }
+    }
+    std::memcpy(buf.data() + used, s, n);
+    used += n;
+  }
+
+  void write(const std::string& s) { write(s.data(), s.size()); }
+
+  void flush() {
+    if (used)
+      std::fwrite(buf.data(), 1, used, file);
+    used = 0;
+  }
+
+  std::FILE* file;
+  std::vector<char> buf;
+  std::size_t used = 0;
+};
+
+
+#endif